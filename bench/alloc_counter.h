@@ -0,0 +1,10 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+
+// The bench replaces the global operator new to count heap allocations made
+// by any thread since startup.
+uint64_t allocationCount();
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,18 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+
+// Microbenchmarks, one per subsystem; run with `bench <name>` or all of them
+// with no argument. Numbers are printed, nothing is asserted.
+void runQueueBenchmark();
+void runMeshingBenchmark();
+void runStorageBenchmark();
+void runLayoutBenchmark();
+
+// Milliseconds since start.
+inline double elapsedMilliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif // BENCH_H
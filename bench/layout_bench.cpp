@@ -0,0 +1,237 @@
+#include "bench.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <glm/glm.hpp>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Voxel layouts under the mesher's access pattern: a face-visibility scan
+// testing all six neighbours of every solid block. The old layout was
+// x-fastest with float index math; chunks are now Y-major with integer
+// indices, so the scan's inner y loop and its vertical neighbours walk
+// consecutive bytes. Run over one chunk, which stays in cache, and over
+// enough chunks to spill out of it.
+
+namespace {
+
+const int WIDTH = 16;
+const int HEIGHT = 256;
+const int DEPTH = 16;
+const size_t CHUNK_VOLUME = static_cast<size_t>(WIDTH) * HEIGHT * DEPTH;
+
+// Hardware cache misses for this thread, where the kernel exposes them.
+class CacheMissCounter {
+public:
+    CacheMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool isAvailable() const {
+        return fd >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    uint64_t stop() {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd;
+};
+
+// The pre-Y-major Chunk index: x fastest, then y, then z, through floats.
+unsigned int floatXMajorIndex(const glm::vec3& pos) {
+    return static_cast<unsigned int>(pos.x + pos.y * WIDTH + pos.z * WIDTH * HEIGHT);
+}
+
+unsigned int xMajorIndex(int x, int y, int z) {
+    return x + (y + z * HEIGHT) * WIDTH;
+}
+
+// ChunkSection and MeshVolume order.
+unsigned int yMajorIndex(int x, int y, int z) {
+    return y + (z + x * DEPTH) * HEIGHT;
+}
+
+// Rolling terrain: solid below a height that varies per column and chunk.
+bool isSolid(int chunk, int x, int y, int z) {
+    return y < 60 + (x * 7 + z * 3 + chunk * 5) % 13;
+}
+
+template<typename Index>
+std::vector<uint8_t> makeChunks(int chunkCount, Index index) {
+    std::vector<uint8_t> blocks(CHUNK_VOLUME * chunkCount);
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        for (int x = 0; x < WIDTH; ++x) {
+            for (int y = 0; y < HEIGHT; ++y) {
+                for (int z = 0; z < DEPTH; ++z) {
+                    blocks[chunk * CHUNK_VOLUME + index(x, y, z)] = isSolid(chunk, x, y, z);
+                }
+            }
+        }
+    }
+    return blocks;
+}
+
+// Old scan: x, y, z loops over float-indexed, x-fastest storage.
+uint64_t scanFloatXMajor(const uint8_t* blocks) {
+    uint64_t faces = 0;
+    for (int x = 1; x < WIDTH - 1; ++x) {
+        for (int y = 1; y < HEIGHT - 1; ++y) {
+            for (int z = 1; z < DEPTH - 1; ++z) {
+                glm::vec3 pos(x, y, z);
+                if (!blocks[floatXMajorIndex(pos)]) {
+                    continue;
+                }
+                faces += !blocks[floatXMajorIndex(pos + glm::vec3(0, 1, 0))] +
+                         !blocks[floatXMajorIndex(pos + glm::vec3(0, -1, 0))] +
+                         !blocks[floatXMajorIndex(pos + glm::vec3(1, 0, 0))] +
+                         !blocks[floatXMajorIndex(pos + glm::vec3(-1, 0, 0))] +
+                         !blocks[floatXMajorIndex(pos + glm::vec3(0, 0, 1))] +
+                         !blocks[floatXMajorIndex(pos + glm::vec3(0, 0, -1))];
+            }
+        }
+    }
+    return faces;
+}
+
+// Integer indices, same storage and loop order: isolates the index math.
+uint64_t scanXMajor(const uint8_t* blocks) {
+    uint64_t faces = 0;
+    for (int x = 1; x < WIDTH - 1; ++x) {
+        for (int y = 1; y < HEIGHT - 1; ++y) {
+            for (int z = 1; z < DEPTH - 1; ++z) {
+                unsigned int i = xMajorIndex(x, y, z);
+                if (!blocks[i]) {
+                    continue;
+                }
+                faces += !blocks[i + WIDTH] + !blocks[i - WIDTH] + !blocks[i + 1] + !blocks[i - 1] +
+                         !blocks[i + WIDTH * HEIGHT] + !blocks[i - WIDTH * HEIGHT];
+            }
+        }
+    }
+    return faces;
+}
+
+// Current scan: x, z, y loops over Y-major storage.
+uint64_t scanYMajor(const uint8_t* blocks) {
+    uint64_t faces = 0;
+    for (int x = 1; x < WIDTH - 1; ++x) {
+        for (int z = 1; z < DEPTH - 1; ++z) {
+            for (int y = 1; y < HEIGHT - 1; ++y) {
+                unsigned int i = yMajorIndex(x, y, z);
+                if (!blocks[i]) {
+                    continue;
+                }
+                faces += !blocks[i + 1] + !blocks[i - 1] + !blocks[i + HEIGHT] + !blocks[i - HEIGHT] +
+                         !blocks[i + HEIGHT * DEPTH] + !blocks[i - HEIGHT * DEPTH];
+            }
+        }
+    }
+    return faces;
+}
+
+struct ScanResult {
+    double microseconds; // Per chunk.
+    double cacheMisses; // Per chunk; negative when not available.
+    uint64_t faces;
+};
+
+ScanResult timeScan(const std::vector<uint8_t>& blocks, int chunkCount, int passes, uint64_t (*scan)(const uint8_t*)) {
+    CacheMissCounter counter;
+    uint64_t faces = scan(blocks.data()); // Warm-up.
+    faces = 0;
+    counter.start();
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (int chunk = 0; chunk < chunkCount; ++chunk) {
+            faces += scan(blocks.data() + chunk * CHUNK_VOLUME);
+        }
+    }
+    double milliseconds = elapsedMilliseconds(start);
+    uint64_t misses = counter.stop();
+    double scans = static_cast<double>(passes) * chunkCount;
+    return ScanResult{milliseconds * 1000.0 / scans, counter.isAvailable() ? misses / scans : -1.0,
+                      faces / static_cast<uint64_t>(scans)};
+}
+
+} // namespace
+
+void runLayoutBenchmark() {
+    struct WorkingSet {
+        const char* name;
+        int chunks;
+        int passes;
+    };
+    // 64 KB fits in L2; 256 chunks are 16 MB.
+    const WorkingSet workingSets[] = {
+        {"1 chunk", 1, 400},
+        {"256 chunks", 256, 2},
+    };
+    std::vector<uint8_t> xMajor = makeChunks(256, xMajorIndex);
+    std::vector<uint8_t> yMajor = makeChunks(256, yMajorIndex);
+
+    struct Layout {
+        const char* name;
+        const std::vector<uint8_t>* blocks;
+        uint64_t (*scan)(const uint8_t*);
+    };
+    const Layout layouts[] = {
+        {"float x-fastest", &xMajor, scanFloatXMajor},
+        {"int x-fastest", &xMajor, scanXMajor},
+        {"int Y-major", &yMajor, scanYMajor},
+    };
+
+    std::printf("%-11s %-16s %12s %16s %8s\n", "", "", "us per chunk", "misses per chunk", "faces");
+    for (const WorkingSet& workingSet : workingSets) {
+        for (const Layout& layout : layouts) {
+            ScanResult result = timeScan(*layout.blocks, workingSet.chunks, workingSet.passes, layout.scan);
+            std::printf("%-11s %-16s %12.1f", workingSet.name, layout.name, result.microseconds);
+            if (result.cacheMisses >= 0.0) {
+                std::printf(" %16.0f", result.cacheMisses);
+            } else {
+                std::printf(" %16s", "n/a");
+            }
+            std::printf(" %8llu\n", static_cast<unsigned long long>(result.faces));
+        }
+    }
+}
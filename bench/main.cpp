@@ -0,0 +1,40 @@
+#include "bench.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+const Benchmark BENCHMARKS[] = {
+    {"queues", runQueueBenchmark},
+    {"meshing", runMeshingBenchmark},
+    {"storage", runStorageBenchmark},
+    {"layout", runLayoutBenchmark},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool ranAny = false;
+    for (const Benchmark& benchmark : BENCHMARKS) {
+        if (argc > 1 && std::strcmp(argv[1], benchmark.name) != 0) {
+            continue;
+        }
+        std::printf("== %s\n", benchmark.name);
+        benchmark.run();
+        ranAny = true;
+    }
+    if (!ranAny) {
+        std::printf("Usage: %s [", argv[0]);
+        for (const Benchmark& benchmark : BENCHMARKS) {
+            std::printf(" %s", benchmark.name);
+        }
+        std::printf(" ]\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "alloc_counter.h"
+#include "world_fixture.h"
+#include "world/chunk/chunk_manager.h"
+
+// Heap allocations and time per chunk mesh, per meshing mode, with the mesh
+// buffers recycled through a MeshDataPool as ChunkManager does and without.
+
+namespace {
+
+const int RADIUS = 2;
+const int REPEATS = 4;
+
+struct MeshingResult {
+    double milliseconds = 0.0; // Per mesh.
+    double allocations = 0.0;
+};
+
+MeshingResult meshAll(const std::vector<std::shared_ptr<Chunk>>& chunks, MeshingMode mode, MeshDataPool* pool) {
+    uint64_t allocationsBefore = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        for (const std::shared_ptr<Chunk>& chunk : chunks) {
+            MeshData mesh;
+            if (pool) {
+                pool->acquire(mesh);
+            }
+            chunk->getMesh(mesh, mode);
+            if (pool) {
+                pool->release(std::move(mesh));
+            }
+        }
+    }
+    double meshes = static_cast<double>(chunks.size() * REPEATS);
+    MeshingResult result;
+    result.milliseconds = elapsedMilliseconds(start) / meshes;
+    result.allocations = static_cast<double>(allocationCount() - allocationsBefore) / meshes;
+    return result;
+}
+
+} // namespace
+
+void runMeshingBenchmark() {
+    ChunkManager manager(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, RADIUS + 2);
+    manager.init(1234u);
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    for (const glm::ivec2& chunkPos : loadChunksAroundOrigin(manager, RADIUS)) {
+        chunks.push_back(manager.getChunk(chunkPos));
+    }
+    MeshingStats streaming = manager.getMeshingStats();
+    std::printf("Streaming %zu chunks: %llu meshes, %llu pool misses, %llu buffer growths\n", chunks.size(),
+                static_cast<unsigned long long>(streaming.meshes), static_cast<unsigned long long>(streaming.poolMisses),
+                static_cast<unsigned long long>(streaming.bufferGrowths));
+
+    struct Mode {
+        const char* name;
+        MeshingMode mode;
+    };
+    const Mode modes[] = {
+        {"per-face", MeshingMode::PER_FACE},
+        {"greedy", MeshingMode::GREEDY},
+        {"binary", MeshingMode::BINARY},
+        {"binary greedy", MeshingMode::BINARY_GREEDY},
+    };
+    std::printf("%-14s %10s %14s %10s %14s\n", "", "fresh ms", "fresh allocs", "pooled ms", "pooled allocs");
+    for (const Mode& mode : modes) {
+        MeshDataPool pool(MESH_POOL_SIZE);
+        // Fills the pool and any per-thread scratch buffers.
+        meshAll(chunks, mode.mode, &pool);
+        MeshingResult fresh = meshAll(chunks, mode.mode, nullptr);
+        MeshingResult pooled = meshAll(chunks, mode.mode, &pool);
+        std::printf("%-14s %10.3f %14.1f %10.3f %14.1f\n", mode.name, fresh.milliseconds, fresh.allocations,
+                    pooled.milliseconds, pooled.allocations);
+    }
+}
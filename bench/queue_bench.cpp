@@ -0,0 +1,130 @@
+#include "bench.h"
+#include <cstdio>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "utils/lock_free_queue.h"
+
+// Producers hand meshes to one consumer, as meshing jobs do to the main
+// thread through ChunkManager's render queue.
+
+namespace {
+
+struct Payload {
+    std::vector<uint32_t> words;
+};
+
+// The unbounded locked queue the render queue used to be; tryPop copies.
+template<typename T>
+class MutexQueue {
+public:
+    void push(const T& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push(value);
+    }
+
+    bool tryPop(T& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty()) {
+            return false;
+        }
+        value = queue.front();
+        queue.pop();
+        return true;
+    }
+
+private:
+    std::queue<T> queue;
+    std::mutex mutex;
+};
+
+const size_t QUEUE_CAPACITY = 256; // RENDER_QUEUE_CAPACITY.
+
+// Nanoseconds per item, from the first push to the last pop.
+template<typename Push, typename Pop>
+double timeTransfer(int producers, size_t items, size_t payloadWords, Push push, Pop pop) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int producer = 0; producer < producers; ++producer) {
+        size_t count = items / producers + (static_cast<size_t>(producer) < items % producers ? 1 : 0);
+        threads.emplace_back([=, &push] {
+            for (size_t i = 0; i < count; ++i) {
+                push(Payload{std::vector<uint32_t>(payloadWords, static_cast<uint32_t>(i))});
+            }
+        });
+    }
+    size_t received = 0;
+    uint64_t checksum = 0;
+    while (received < items) {
+        size_t popped = pop(checksum);
+        if (popped == 0) {
+            std::this_thread::yield();
+        }
+        received += popped;
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double nanoseconds = elapsedMilliseconds(start) * 1e6 / static_cast<double>(items);
+    // Keeps the payload reads from being optimised away.
+    if (checksum == 1) {
+        std::printf("%llu\n", static_cast<unsigned long long>(checksum));
+    }
+    return nanoseconds;
+}
+
+double timeMutexQueue(int producers, size_t items, size_t payloadWords) {
+    MutexQueue<Payload> queue;
+    Payload value;
+    return timeTransfer(
+        producers, items, payloadWords, [&](Payload&& payload) { queue.push(payload); },
+        [&](uint64_t& checksum) -> size_t {
+            if (!queue.tryPop(value)) {
+                return 0;
+            }
+            checksum += value.words.size();
+            return 1;
+        });
+}
+
+double timeMpmcQueue(int producers, size_t items, size_t payloadWords) {
+    MpmcQueue<Payload> queue(QUEUE_CAPACITY);
+    std::vector<Payload> batch;
+    return timeTransfer(
+        producers, items, payloadWords, [&](Payload&& payload) { queue.push(std::move(payload)); },
+        [&](uint64_t& checksum) -> size_t {
+            batch.clear();
+            size_t popped = queue.popBatch(batch, QUEUE_CAPACITY);
+            for (const Payload& payload : batch) {
+                checksum += payload.words.size();
+            }
+            return popped;
+        });
+}
+
+} // namespace
+
+void runQueueBenchmark() {
+    struct Workload {
+        const char* name;
+        size_t items;
+        size_t payloadWords;
+    };
+    const Workload workloads[] = {
+        {"empty meshes", 200000, 0},
+        {"8 KB meshes", 20000, 2048},
+    };
+    const int producerCounts[] = {1, 4, 16};
+
+    std::printf("%u hardware threads, one consumer; ns per item\n", std::thread::hardware_concurrency());
+    std::printf("%-14s %9s %10s %8s\n", "", "producers", "mutex", "MPMC");
+    for (const Workload& workload : workloads) {
+        for (int producers : producerCounts) {
+            double mutexTime = timeMutexQueue(producers, workload.items, workload.payloadWords);
+            double mpmcTime = timeMpmcQueue(producers, workload.items, workload.payloadWords);
+            std::printf("%-14s %9d %10.0f %8.0f\n", workload.name, producers, mutexTime, mpmcTime);
+        }
+    }
+}
@@ -0,0 +1,123 @@
+#include "bench.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "world_fixture.h"
+#include "global.h"
+#include "utils/hash.h"
+#include "world/chunk/chunk_manager.h"
+#include "world/chunk/mesher/chunk_mesher.h"
+#include "world/chunk/mesher/mesh_volume.h"
+
+// Palette-compressed chunk sections against the flat one-byte-per-block
+// array they replaced: memory per chunk, and getMesh split into its two
+// stages. Storage only changes how the MeshVolume snapshot is filled; the
+// mesher then reads the same snapshot either way.
+
+namespace {
+
+const int RADIUS = 2;
+const int REPEATS = 8;
+const int WIDTH = static_cast<int>(CHUNK_WIDTH);
+const int HEIGHT = static_cast<int>(CHUNK_HEIGHT);
+const int DEPTH = static_cast<int>(CHUNK_DEPTH);
+
+using FlatChunk = std::vector<VoxelType>; // Columns of HEIGHT blocks, index y + (z + x * DEPTH) * HEIGHT.
+
+FlatChunk flatten(const Chunk& chunk, MeshVolume& scratch) {
+    scratch.fill(chunk, {});
+    FlatChunk flat(static_cast<size_t>(WIDTH) * HEIGHT * DEPTH);
+    for (int x = 0; x < WIDTH; ++x) {
+        for (int z = 0; z < DEPTH; ++z) {
+            const VoxelType* column = scratch.getColumn(x, z);
+            std::copy(column, column + HEIGHT, flat.begin() + (z + x * DEPTH) * HEIGHT);
+        }
+    }
+    return flat;
+}
+
+void copyFlatColumns(const FlatChunk& flat, const glm::ivec2& min, const glm::ivec2& max, MeshVolume& volume,
+                     const glm::ivec2& volumeOffset) {
+    for (int x = min.x; x < max.x; ++x) {
+        for (int z = min.y; z < max.y; ++z) {
+            const VoxelType* column = flat.data() + (z + x * DEPTH) * HEIGHT;
+            std::copy(column, column + HEIGHT, volume.getColumn(x + volumeOffset.x, z + volumeOffset.y));
+        }
+    }
+}
+
+// MeshVolume::fill from flat arrays; the neighbours are always loaded here.
+void fillFromFlat(const FlatChunk& chunk, const std::array<const FlatChunk*, 4>& neighbors, MeshVolume& volume) {
+    copyFlatColumns(chunk, {0, 0}, {WIDTH, DEPTH}, volume, {0, 0});
+    copyFlatColumns(*neighbors[NEIGHBOR_POS_X], {0, 0}, {1, DEPTH}, volume, {WIDTH, 0});
+    copyFlatColumns(*neighbors[NEIGHBOR_NEG_X], {WIDTH - 1, 0}, {WIDTH, DEPTH}, volume, {-WIDTH, 0});
+    copyFlatColumns(*neighbors[NEIGHBOR_POS_Z], {0, 0}, {WIDTH, 1}, volume, {0, DEPTH});
+    copyFlatColumns(*neighbors[NEIGHBOR_NEG_Z], {0, DEPTH - 1}, {WIDTH, DEPTH}, volume, {0, -DEPTH});
+}
+
+const glm::ivec2 NEIGHBOR_OFFSETS[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}}; // MeshNeighbor order.
+
+} // namespace
+
+void runStorageBenchmark() {
+    ChunkManager manager(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, RADIUS + 2);
+    manager.init(1234u);
+    std::vector<glm::ivec2> chunkPositions = loadChunksAroundOrigin(manager, RADIUS);
+
+    MeshVolume volume(WIDTH, HEIGHT, DEPTH);
+    std::unordered_map<glm::ivec2, FlatChunk, IVec2Hash> flatChunks;
+    size_t palettedBytes = 0;
+    for (const glm::ivec2& chunkPos : chunkPositions) {
+        palettedBytes += manager.getChunk(chunkPos)->getMemoryUsage();
+        for (int i = -1; i < 4; ++i) {
+            glm::ivec2 pos = chunkPos + (i < 0 ? glm::ivec2(0) : NEIGHBOR_OFFSETS[i]);
+            if (flatChunks.find(pos) == flatChunks.end()) {
+                flatChunks[pos] = flatten(*manager.getChunk(pos), volume);
+            }
+        }
+    }
+    size_t chunkCount = chunkPositions.size();
+    size_t flatBytes = chunkCount * static_cast<size_t>(WIDTH) * HEIGHT * DEPTH * sizeof(VoxelType);
+    std::printf("%zu chunks, memory per chunk: paletted %.1f KB, flat %.1f KB (%.1fx smaller)\n", chunkCount,
+                palettedBytes / (1024.0 * chunkCount), flatBytes / (1024.0 * chunkCount),
+                static_cast<double>(flatBytes) / static_cast<double>(palettedBytes));
+
+    double palettedFill = 0.0;
+    double flatFill = 0.0;
+    double meshing = 0.0;
+    MeshData mesh;
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        for (const glm::ivec2& chunkPos : chunkPositions) {
+            std::shared_ptr<Chunk> chunk = manager.getChunk(chunkPos);
+            std::array<std::shared_ptr<Chunk>, 4> neighbors;
+            std::array<const FlatChunk*, 4> flatNeighbors;
+            for (int i = 0; i < 4; ++i) {
+                neighbors[i] = manager.getChunk(chunkPos + NEIGHBOR_OFFSETS[i]);
+                flatNeighbors[i] = &flatChunks[chunkPos + NEIGHBOR_OFFSETS[i]];
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            fillFromFlat(flatChunks[chunkPos], flatNeighbors, volume);
+            flatFill += elapsedMilliseconds(start);
+
+            // Last, so the volume also carries fill's empty-section mask for the mesher.
+            start = std::chrono::steady_clock::now();
+            volume.fill(*chunk, neighbors);
+            palettedFill += elapsedMilliseconds(start);
+
+            start = std::chrono::steady_clock::now();
+            mesh.clear();
+            glm::vec3 offset(chunkPos.x * WIDTH, 0, chunkPos.y * DEPTH);
+            ChunkMesher(MeshingMode::BINARY_GREEDY).buildMesh(volume, offset, mesh);
+            meshing += elapsedMilliseconds(start);
+        }
+    }
+    double meshes = static_cast<double>(chunkCount * REPEATS);
+    std::printf("getMesh per chunk, binary greedy: volume fill paletted %.3f ms, flat %.3f ms; meshing %.3f ms\n",
+                palettedFill / meshes, flatFill / meshes, meshing / meshes);
+    std::printf("getMesh throughput: paletted %.0f chunks/s, flat %.0f chunks/s\n",
+                meshes * 1000.0 / (palettedFill + meshing), meshes * 1000.0 / (flatFill + meshing));
+}
@@ -0,0 +1,29 @@
+#include "world_fixture.h"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <unordered_set>
+#include "utils/hash.h"
+
+std::vector<glm::ivec2> loadChunksAroundOrigin(ChunkManager& manager, int radius) {
+    std::unordered_set<glm::ivec2, IVec2Hash> meshed;
+    std::vector<ChunkMeshUpdate> updates;
+    size_t wanted = static_cast<size_t>((2 * radius + 1) * (2 * radius + 1));
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    manager.updatePlayerPosition(glm::vec3(8.0f, 100.0f, 8.0f));
+    while (found < wanted && std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+        manager.updateChunks();
+        updates.clear();
+        manager.getRenderQueue().popBatch(updates, RENDER_QUEUE_CAPACITY);
+        for (ChunkMeshUpdate& update : updates) {
+            glm::ivec2 pos = update.chunkPos;
+            if (std::abs(pos.x) <= radius && std::abs(pos.y) <= radius && meshed.insert(pos).second) {
+                found++;
+            }
+            manager.recycleMesh(std::move(update.mesh));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return std::vector<glm::ivec2>(meshed.begin(), meshed.end());
+}
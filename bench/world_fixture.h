@@ -0,0 +1,13 @@
+#ifndef WORLD_FIXTURE_H
+#define WORLD_FIXTURE_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "world/chunk/chunk_manager.h"
+
+// Streams the world around the origin until every chunk within radius has
+// been meshed, and returns those chunks. Their neighbours are loaded too, so
+// they can be meshed again.
+std::vector<glm::ivec2> loadChunksAroundOrigin(ChunkManager& manager, int radius);
+
+#endif // WORLD_FIXTURE_H
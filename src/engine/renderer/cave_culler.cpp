@@ -0,0 +1,105 @@
+#include "cave_culler.h"
+#include "../../world/chunk/mesher/section_connectivity.h"
+#include "../../world/chunk/chunk_section.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Grid steps per SectionFace.
+constexpr int FACE_STEPS[SECTION_FACE_COUNT][3] = {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}
+};
+
+} // namespace
+
+CaveCuller::CaveCuller()
+    : centerChunk(0), radius(0), side(1), allReachable(true), reachableCount(0) {
+}
+
+void CaveCuller::beginFrame(const glm::ivec2& newCenterChunk, int newRadius) {
+    centerChunk = newCenterChunk;
+    radius = newRadius;
+    side = 2 * radius + 1;
+    size_t cells = static_cast<size_t>(side) * side * MeshData::SECTION_COUNT;
+    connectivity.assign(cells, ALL_FACES_CONNECTED);
+    reachable.assign(cells, 0);
+}
+
+void CaveCuller::setChunk(const glm::ivec2& chunkPos, const Connectivity& chunkConnectivity) {
+    glm::ivec2 local = chunkPos - centerChunk + radius;
+    if (local.x < 0 || local.x >= side || local.y < 0 || local.y >= side) {
+        return;
+    }
+    std::copy(chunkConnectivity.begin(), chunkConnectivity.end(), &connectivity[gridIndex(local.x, 0, local.y)]);
+}
+
+void CaveCuller::findReachableSections(const glm::vec3& cameraPos, const Frustum& frustum) {
+    reachableCount = 0;
+    float sectionSize = static_cast<float>(ChunkSection::SIZE);
+    glm::ivec3 start(static_cast<int>(std::floor(cameraPos.x / CHUNK_WIDTH)) - centerChunk.x + radius,
+                     static_cast<int>(std::floor(cameraPos.y / sectionSize)),
+                     static_cast<int>(std::floor(cameraPos.z / CHUNK_DEPTH)) - centerChunk.y + radius);
+    allReachable = start.y < 0 || start.y >= MeshData::SECTION_COUNT ||
+                   start.x < 0 || start.x >= side || start.z < 0 || start.z >= side;
+    if (allReachable) {
+        return;
+    }
+
+    queue.clear();
+    int startIndex = gridIndex(start.x, start.y, start.z);
+    reachable[startIndex] = 1;
+    queue.push_back(Step{startIndex, SECTION_FACE_COUNT, 0});
+    glm::vec3 gridOrigin((centerChunk.x - radius) * CHUNK_WIDTH, 0.0f, (centerChunk.y - radius) * CHUNK_DEPTH);
+    glm::vec3 boxSize(CHUNK_WIDTH, sectionSize, CHUNK_DEPTH);
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Step step = queue[head];
+        int y = step.index % MeshData::SECTION_COUNT;
+        int z = (step.index / MeshData::SECTION_COUNT) % side;
+        int x = step.index / (MeshData::SECTION_COUNT * side);
+
+        for (int face = 0; face < SECTION_FACE_COUNT; ++face) {
+            if (step.directions & (1 << oppositeSectionFace(face))) {
+                continue;
+            }
+            if (step.enteredFace != SECTION_FACE_COUNT &&
+                !areSectionFacesConnected(connectivity[step.index], step.enteredFace, face)) {
+                continue;
+            }
+
+            int nextX = x + FACE_STEPS[face][0];
+            int nextY = y + FACE_STEPS[face][1];
+            int nextZ = z + FACE_STEPS[face][2];
+            if (nextX < 0 || nextX >= side || nextY < 0 || nextY >= MeshData::SECTION_COUNT ||
+                nextZ < 0 || nextZ >= side) {
+                continue;
+            }
+            int next = gridIndex(nextX, nextY, nextZ);
+            if (reachable[next]) {
+                continue;
+            }
+            glm::vec3 min = gridOrigin + glm::vec3(nextX, nextY, nextZ) * boxSize;
+            if (!frustum.isBoxVisible(min, min + boxSize)) {
+                continue;
+            }
+
+            reachable[next] = 1;
+            queue.push_back(Step{next, static_cast<uint8_t>(oppositeSectionFace(face)),
+                                 static_cast<uint8_t>(step.directions | (1 << face))});
+        }
+    }
+    reachableCount = queue.size();
+}
+
+bool CaveCuller::isSectionReachable(const glm::ivec2& chunkPos, int sectionY) const {
+    glm::ivec2 local = chunkPos - centerChunk + radius;
+    if (allReachable || local.x < 0 || local.x >= side || local.y < 0 || local.y >= side) {
+        return true;
+    }
+    return reachable[gridIndex(local.x, sectionY, local.y)] != 0;
+}
+
+size_t CaveCuller::getReachableCount() const {
+    return reachableCount;
+}
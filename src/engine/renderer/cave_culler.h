@@ -0,0 +1,53 @@
+#ifndef CAVE_CULLER_H
+#define CAVE_CULLER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "frustum.hpp"
+#include "../../world/chunk/mesher/mesh_data.h"
+
+// Finds the sections that can be seen from the camera's section by walking
+// outward through open space: a breadth-first search that leaves a section
+// only through a face joined to the one it came in by, never heads back
+// towards the camera, and stays in the frustum. Sealed caves and buried
+// sections are never reached. Works on a square grid of chunks around the
+// camera; chunks without connectivity data count as open.
+class CaveCuller {
+public:
+    using Connectivity = std::array<uint16_t, MeshData::SECTION_COUNT>;
+
+    CaveCuller();
+
+    void beginFrame(const glm::ivec2& centerChunk, int radius);
+    void setChunk(const glm::ivec2& chunkPos, const Connectivity& connectivity);
+    void findReachableSections(const glm::vec3& cameraPos, const Frustum& frustum);
+    // Sections outside the grid, or every section when the camera is above
+    // or below the world, count as reachable.
+    bool isSectionReachable(const glm::ivec2& chunkPos, int sectionY) const;
+    size_t getReachableCount() const;
+
+private:
+    struct Step {
+        int index;
+        uint8_t enteredFace; // SECTION_FACE_COUNT for the camera's own section.
+        uint8_t directions; // Every direction taken so far, one bit per face.
+    };
+
+    int gridIndex(int x, int y, int z) const {
+        return y + (z + x * side) * MeshData::SECTION_COUNT;
+    }
+
+    glm::ivec2 centerChunk;
+    int radius;
+    int side;
+    bool allReachable;
+    size_t reachableCount;
+    std::vector<uint16_t> connectivity;
+    std::vector<uint8_t> reachable;
+    std::vector<Step> queue;
+};
+
+#endif // CAVE_CULLER_H
@@ -0,0 +1,77 @@
+#include "free_list_allocator.h"
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(size_t capacity)
+    : capacity(0), used(0) {
+    grow(capacity);
+}
+
+bool FreeListAllocator::allocate(size_t size, size_t& offset) {
+    if (size == 0) {
+        offset = 0;
+        return true;
+    }
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < size) {
+            continue;
+        }
+
+        offset = it->first;
+        size_t remaining = it->second - size;
+        freeRanges.erase(it);
+        if (remaining > 0) {
+            freeRanges.emplace(offset + size, remaining);
+        }
+        used += size;
+        return true;
+    }
+    return false;
+}
+
+void FreeListAllocator::free(size_t offset, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    used -= size;
+
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            freeRanges.erase(previous);
+        }
+    }
+    if (next != freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        freeRanges.erase(next);
+    }
+    freeRanges.emplace(offset, size);
+}
+
+void FreeListAllocator::grow(size_t newCapacity) {
+    if (newCapacity <= capacity) {
+        return;
+    }
+
+    size_t added = newCapacity - capacity;
+    size_t oldCapacity = capacity;
+    capacity = newCapacity;
+    // Counted as used for a moment so free() can merge it like any other range.
+    used += added;
+    free(oldCapacity, added);
+}
+
+size_t FreeListAllocator::getCapacity() const {
+    return capacity;
+}
+
+size_t FreeListAllocator::getUsed() const {
+    return used;
+}
+
+size_t FreeListAllocator::getFreeRangeCount() const {
+    return freeRanges.size();
+}
@@ -0,0 +1,31 @@
+#ifndef FREE_LIST_ALLOCATOR_H
+#define FREE_LIST_ALLOCATOR_H
+
+#include <cstddef>
+#include <map>
+
+// Hands out ranges of a fixed-size arena, in caller-defined units. Free ranges
+// are kept sorted by offset and merged with their neighbours on free, so the
+// arena doesn't splinter as ranges of different sizes come and go. Allocation
+// is first fit.
+class FreeListAllocator {
+public:
+    explicit FreeListAllocator(size_t capacity = 0);
+
+    // Returns false, leaving offset untouched, when no free range is big enough.
+    bool allocate(size_t size, size_t& offset);
+    void free(size_t offset, size_t size);
+    // Adds newCapacity - capacity units at the end of the arena.
+    void grow(size_t newCapacity);
+
+    size_t getCapacity() const;
+    size_t getUsed() const;
+    size_t getFreeRangeCount() const;
+
+private:
+    std::map<size_t, size_t> freeRanges; // Offset to size.
+    size_t capacity;
+    size_t used;
+};
+
+#endif // FREE_LIST_ALLOCATOR_H
@@ -55,16 +55,24 @@ public:
         }
     }
 
-    bool isChunkVisible(const glm::ivec2& chunkPos) const {
-        glm::vec3 center(chunkPos.x * CHUNK_WIDTH + CHUNK_WIDTH / 2, CHUNK_HEIGHT / 2, chunkPos.y * CHUNK_DEPTH + CHUNK_DEPTH / 2);
-        
-        // Radius of a sphere that encloses a 16x256x16 cuboid
-        float radius = sqrt(8.0f*8.0f + 128.0f*128.0f + 8.0f*8.0f);
+    // Column from minY to maxY; the whole chunk height by default.
+    bool isChunkVisible(const glm::ivec2& chunkPos, float minY = 0.0f, float maxY = CHUNK_HEIGHT) const {
+        glm::vec3 min(chunkPos.x * CHUNK_WIDTH, minY, chunkPos.y * CHUNK_DEPTH);
+        return isBoxVisible(min, min + glm::vec3(CHUNK_WIDTH, maxY - minY, CHUNK_DEPTH));
+    }
 
-        float margin = 2.0f;
+    // Tests the box corner furthest along each plane normal (the p-vertex):
+    // if even that one is behind a plane, the whole box is. Conservative, a box
+    // near a frustum corner can pass while being outside.
+    bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
+        // Water is drawn 0.2 lower and faces sit on block bounds.
+        float margin = 0.5f;
 
         for(int i = 0; i < 6; i++) {
-            if(planes[i].x * center.x + planes[i].y * center.y + planes[i].z * center.z + planes[i].w <= -(radius + margin)) {
+            glm::vec3 positive(planes[i].x >= 0.0f ? max.x : min.x,
+                               planes[i].y >= 0.0f ? max.y : min.y,
+                               planes[i].z >= 0.0f ? max.z : min.z);
+            if(planes[i].x * positive.x + planes[i].y * positive.y + planes[i].z * positive.z + planes[i].w < -margin) {
                 return false;
             }
         }
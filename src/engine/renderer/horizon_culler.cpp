@@ -0,0 +1,138 @@
+#include "horizon_culler.h"
+#include "../../global.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+// Directions from the camera to a chunk's corners, in bins, as an unwrapped
+// range [first, last]. The camera is outside the chunk, so the range is
+// narrower than half a turn.
+void findAngularRange(const glm::vec2& camera, const glm::vec2& min, const glm::vec2& max, int binCount,
+                      float& first, float& last) {
+    glm::vec2 center = (min + max) * 0.5f;
+    float centerAngle = std::atan2(center.y - camera.y, center.x - camera.x);
+    float lowest = 0.0f;
+    float highest = 0.0f;
+    const glm::vec2 corners[4] = {min, glm::vec2(max.x, min.y), glm::vec2(min.x, max.y), max};
+    for (const glm::vec2& corner : corners) {
+        float offset = std::atan2(corner.y - camera.y, corner.x - camera.x) - centerAngle;
+        if (offset > PI) {
+            offset -= 2.0f * PI;
+        } else if (offset < -PI) {
+            offset += 2.0f * PI;
+        }
+        lowest = std::min(lowest, offset);
+        highest = std::max(highest, offset);
+    }
+    float binsPerRadian = binCount / (2.0f * PI);
+    first = (centerAngle + lowest) * binsPerRadian;
+    last = (centerAngle + highest) * binsPerRadian;
+}
+
+int wrapBin(int bin, int binCount) {
+    bin %= binCount;
+    return bin < 0 ? bin + binCount : bin;
+}
+
+} // namespace
+
+HorizonCuller::HorizonCuller()
+    : centerChunk(0), radius(0), side(1), cameraY(0.0f), occluderCount(0) {
+    bins.fill(-std::numeric_limits<float>::infinity());
+}
+
+void HorizonCuller::beginFrame(const glm::ivec2& newCenterChunk, int newRadius) {
+    centerChunk = newCenterChunk;
+    radius = newRadius;
+    side = 2 * radius + 1;
+    float lowest = -std::numeric_limits<float>::infinity();
+    cells.assign(static_cast<size_t>(side) * side, Cell{0, 0.0f, 0.0f, lowest});
+}
+
+void HorizonCuller::setChunk(const glm::ivec2& chunkPos, int solidHeight) {
+    glm::ivec2 local = chunkPos - centerChunk + radius;
+    if (local.x < 0 || local.x >= side || local.y < 0 || local.y >= side) {
+        return;
+    }
+    cells[cellIndex(local)].solidHeight = solidHeight;
+}
+
+void HorizonCuller::buildHorizon(const glm::vec3& cameraPos) {
+    float lowest = -std::numeric_limits<float>::infinity();
+    bins.fill(lowest);
+    occluderCount = 0;
+    cameraY = cameraPos.y;
+
+    glm::vec2 camera(cameraPos.x, cameraPos.z);
+    glm::vec2 chunkSize(CHUNK_WIDTH, CHUNK_DEPTH);
+    for (int ring = 1; ring <= radius; ++ring) {
+        // Test the whole ring against the nearer rings before it adds its own terrain.
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int x = -ring; x <= ring; ++x) {
+                int step = (x == -ring || x == ring) ? 1 : 2 * ring;
+                for (int z = -ring; z <= ring; z += step) {
+                    glm::ivec2 local(x + radius, z + radius);
+                    Cell& cell = cells[cellIndex(local)];
+                    glm::vec2 min = glm::vec2(centerChunk + glm::ivec2(x, z)) * chunkSize;
+                    glm::vec2 max = min + chunkSize;
+                    float first, last;
+                    findAngularRange(camera, min, max, BIN_COUNT, first, last);
+
+                    if (pass == 0) {
+                        float nearX = camera.x - std::clamp(camera.x, min.x, max.x);
+                        float nearZ = camera.y - std::clamp(camera.y, min.y, max.y);
+                        float farX = std::max(std::abs(camera.x - min.x), std::abs(camera.x - max.x));
+                        float farZ = std::max(std::abs(camera.y - min.y), std::abs(camera.y - max.y));
+                        // Kept above zero so slopes stay finite next to the camera's chunk.
+                        cell.nearest = std::max(std::sqrt(nearX * nearX + nearZ * nearZ), 0.001f);
+                        cell.farthest = std::sqrt(farX * farX + farZ * farZ);
+                        // Every bin the chunk touches.
+                        float horizon = std::numeric_limits<float>::infinity();
+                        for (int bin = static_cast<int>(std::floor(first)); bin < static_cast<int>(std::ceil(last)); ++bin) {
+                            horizon = std::min(horizon, bins[wrapBin(bin, BIN_COUNT)]);
+                        }
+                        cell.horizon = horizon;
+                        continue;
+                    }
+
+                    if (cell.solidHeight <= 0) {
+                        continue;
+                    }
+                    // Only bins entirely within the chunk, so every ray in them
+                    // crosses it. The slope is the lowest any such ray can
+                    // have and still pass above the solid layers.
+                    float height = cell.solidHeight - cameraPos.y;
+                    float slope = height / (height > 0.0f ? cell.farthest : cell.nearest);
+                    for (int bin = static_cast<int>(std::ceil(first)); bin < static_cast<int>(std::floor(last)); ++bin) {
+                        float& binSlope = bins[wrapBin(bin, BIN_COUNT)];
+                        binSlope = std::max(binSlope, slope);
+                    }
+                    occluderCount++;
+                }
+            }
+        }
+    }
+}
+
+bool HorizonCuller::isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
+    glm::ivec2 chunkPos(static_cast<int>(std::floor(min.x / CHUNK_WIDTH)), static_cast<int>(std::floor(min.z / CHUNK_DEPTH)));
+    glm::ivec2 local = chunkPos - centerChunk + radius;
+    if (local.x < 0 || local.x >= side || local.y < 0 || local.y >= side || local == glm::ivec2(radius)) {
+        return true;
+    }
+
+    // The steepest ray to any point of the box goes to its top, at the near
+    // side when the top is above the camera and the far side otherwise.
+    const Cell& cell = cells[cellIndex(local)];
+    float height = max.y - cameraY;
+    float slope = height / (height > 0.0f ? cell.nearest : cell.farthest);
+    return slope >= cell.horizon;
+}
+
+size_t HorizonCuller::getOccluderCount() const {
+    return occluderCount;
+}
@@ -0,0 +1,69 @@
+#ifndef HORIZON_CULLER_H
+#define HORIZON_CULLER_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Culls boxes hidden behind nearer terrain. Each chunk is solid from the
+// bottom up to its solid height, the layers where every column occludes, so
+// seen from the camera a chunk blocks every ray that passes under that height.
+// The culler sweeps outward over the chunk grid, one square ring around the
+// camera's chunk at a time, and keeps the highest blocked slope per direction;
+// a box is below the horizon when its top lies under that slope in every
+// direction it covers. Rays leave the camera's chunk through ever farther
+// rings, so only rings already swept can be in front of a box.
+class HorizonCuller {
+public:
+    HorizonCuller();
+
+    void beginFrame(const glm::ivec2& centerChunk, int radius);
+    void setChunk(const glm::ivec2& chunkPos, int solidHeight);
+    void buildHorizon(const glm::vec3& cameraPos);
+    // The box must lie within one chunk column. Boxes outside the grid are
+    // never culled.
+    bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+    size_t getOccluderCount() const;
+
+private:
+    static constexpr int BIN_COUNT = 1024; // Directions around the camera.
+
+    struct Cell {
+        int solidHeight; // 0 until setChunk, which blocks nothing.
+        float nearest; // Horizontal distance from the camera, to the chunk's closest and farthest points.
+        float farthest;
+        float horizon; // Lowest blocked slope over the directions the chunk covers.
+    };
+
+    int cellIndex(const glm::ivec2& local) const {
+        return local.x * side + local.y;
+    }
+
+    glm::ivec2 centerChunk;
+    int radius;
+    int side;
+    float cameraY;
+    size_t occluderCount;
+    std::vector<Cell> cells;
+    std::array<float, BIN_COUNT> bins;
+};
+
+// A chunk's solid height from MeshData::solidLayers: the full layers from the
+// bottom up, so a cave, an overhang or water in any column ends the run.
+template <size_t LayerWords>
+int findSolidHeight(const std::array<uint64_t, LayerWords>& solidLayers) {
+    int height = 0;
+    for (uint64_t word : solidLayers) {
+        int ones = std::countr_one(word);
+        height += ones;
+        if (ones < 64) {
+            break;
+        }
+    }
+    return height;
+}
+
+#endif // HORIZON_CULLER_H
@@ -0,0 +1,162 @@
+#include "occlusion_culler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Anything this close to the camera plane can't be projected reliably;
+// occluders there are skipped and occludees count as visible.
+constexpr float MIN_W = 0.1f;
+
+glm::vec2 toScreen(const glm::vec4& clip) {
+    return glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * OcclusionCuller::WIDTH,
+                     (clip.y / clip.w * 0.5f + 0.5f) * OcclusionCuller::HEIGHT);
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller()
+    : viewProjection(1.0f), cameraPos(0.0f),
+      depth(WIDTH * HEIGHT, std::numeric_limits<float>::infinity()), occluderCount(0) {
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& newViewProjection, const glm::vec3& newCameraPos) {
+    viewProjection = newViewProjection;
+    cameraPos = newCameraPos;
+    std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::infinity());
+    occluderCount = 0;
+}
+
+// Only the faces the camera is in front of can be seen, at most three.
+void OcclusionCuller::addOccluder(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec4 corners[8];
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+        corners[i] = viewProjection * glm::vec4(corner, 1.0f);
+    }
+
+    // Corner indices per face, in order around the face.
+    static constexpr int FACES[6][4] = {
+        {0, 2, 6, 4}, {1, 3, 7, 5}, // -X, +X
+        {0, 1, 5, 4}, {2, 3, 7, 6}, // -Y, +Y
+        {0, 1, 3, 2}, {4, 5, 7, 6}  // -Z, +Z
+    };
+    bool facing[6] = {
+        cameraPos.x < min.x, cameraPos.x > max.x,
+        cameraPos.y < min.y, cameraPos.y > max.y,
+        cameraPos.z < min.z, cameraPos.z > max.z
+    };
+
+    bool drawn = false;
+    for (int face = 0; face < 6; ++face) {
+        if (!facing[face]) {
+            continue;
+        }
+        glm::vec4 quad[4] = {corners[FACES[face][0]], corners[FACES[face][1]],
+                             corners[FACES[face][2]], corners[FACES[face][3]]};
+        rasterizeQuad(quad);
+        drawn = true;
+    }
+    occluderCount += drawn;
+}
+
+// Pixels whose centre is inside the projected quad take the quad's farthest
+// depth. Edge functions are evaluated per row as a * x + rowOffset, which
+// the compiler turns into vector compares and selects.
+void OcclusionCuller::rasterizeQuad(const glm::vec4* corners) {
+    float farthest = 0.0f;
+    glm::vec2 screen[4];
+    for (int i = 0; i < 4; ++i) {
+        if (corners[i].w < MIN_W) {
+            return;
+        }
+        farthest = std::max(farthest, corners[i].w);
+        screen[i] = toScreen(corners[i]);
+    }
+
+    float area = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+        const glm::vec2& a = screen[i];
+        const glm::vec2& b = screen[(i + 1) % 4];
+        area += a.x * b.y - b.x * a.y;
+    }
+    if (std::abs(area) < 1e-6f) {
+        return; // Edge on.
+    }
+    float orientation = area > 0.0f ? 1.0f : -1.0f;
+
+    // Inside when a * x + b * y + c >= 0 for every edge.
+    float edgeA[4], edgeB[4], edgeC[4];
+    for (int i = 0; i < 4; ++i) {
+        const glm::vec2& p = screen[i];
+        const glm::vec2& q = screen[(i + 1) % 4];
+        edgeA[i] = -(q.y - p.y) * orientation;
+        edgeB[i] = (q.x - p.x) * orientation;
+        edgeC[i] = -(edgeA[i] * p.x + edgeB[i] * p.y);
+    }
+
+    glm::vec2 low = glm::min(glm::min(screen[0], screen[1]), glm::min(screen[2], screen[3]));
+    glm::vec2 high = glm::max(glm::max(screen[0], screen[1]), glm::max(screen[2], screen[3]));
+    int minX = std::max(0, static_cast<int>(std::floor(low.x)));
+    int minY = std::max(0, static_cast<int>(std::floor(low.y)));
+    int maxX = std::min(WIDTH - 1, static_cast<int>(std::ceil(high.x)));
+    int maxY = std::min(HEIGHT - 1, static_cast<int>(std::ceil(high.y)));
+
+    for (int y = minY; y <= maxY; ++y) {
+        float centerY = y + 0.5f;
+        float rowOffset[4];
+        for (int i = 0; i < 4; ++i) {
+            rowOffset[i] = edgeB[i] * centerY + edgeC[i];
+        }
+
+        float* row = &depth[y * WIDTH];
+        for (int x = minX; x <= maxX; ++x) {
+            float centerX = x + 0.5f;
+            bool inside = (edgeA[0] * centerX + rowOffset[0] >= 0.0f) & (edgeA[1] * centerX + rowOffset[1] >= 0.0f) &
+                          (edgeA[2] * centerX + rowOffset[2] >= 0.0f) & (edgeA[3] * centerX + rowOffset[3] >= 0.0f);
+            row[x] = inside ? std::min(row[x], farthest) : row[x];
+        }
+    }
+}
+
+bool OcclusionCuller::isBoxVisible(const glm::vec3& min, const glm::vec3& max) const {
+    float nearest = std::numeric_limits<float>::infinity();
+    glm::vec2 low(std::numeric_limits<float>::infinity());
+    glm::vec2 high(-std::numeric_limits<float>::infinity());
+    for (int i = 0; i < 8; ++i) {
+        glm::vec3 corner(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+        glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+        if (clip.w < MIN_W) {
+            return true;
+        }
+        nearest = std::min(nearest, clip.w);
+        glm::vec2 screen = toScreen(clip);
+        low = glm::min(low, screen);
+        high = glm::max(high, screen);
+    }
+
+    int minX = std::max(0, static_cast<int>(std::floor(low.x)) - 1);
+    int minY = std::max(0, static_cast<int>(std::floor(low.y)) - 1);
+    int maxX = std::min(WIDTH - 1, static_cast<int>(std::ceil(high.x)) + 1);
+    int maxY = std::min(HEIGHT - 1, static_cast<int>(std::ceil(high.y)) + 1);
+    if (minX > maxX || minY > maxY) {
+        return true; // Off screen; left to the frustum test.
+    }
+
+    for (int y = minY; y <= maxY; ++y) {
+        const float* row = &depth[y * WIDTH];
+        bool uncovered = false;
+        for (int x = minX; x <= maxX; ++x) {
+            uncovered |= row[x] >= nearest;
+        }
+        if (uncovered) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t OcclusionCuller::getOccluderCount() const {
+    return occluderCount;
+}
@@ -0,0 +1,36 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Occlusion culling on the CPU against a small depth buffer. Occluders are
+// boxes known to be solid; each camera-facing face is rasterized at the
+// farthest depth of its corners, so the buffer never holds anything nearer
+// than the real occluder. A box is hidden when its nearest corner is behind
+// the buffer over its whole screen rectangle, grown by a pixel to cover the
+// rasterizer's pixel-centre sampling. Depth is view distance (clip w), which
+// needs no perspective interpolation since faces are written at one depth.
+class OcclusionCuller {
+public:
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 160;
+
+    OcclusionCuller();
+
+    void beginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+    void addOccluder(const glm::vec3& min, const glm::vec3& max);
+    bool isBoxVisible(const glm::vec3& min, const glm::vec3& max) const;
+    size_t getOccluderCount() const;
+
+private:
+    void rasterizeQuad(const glm::vec4* corners);
+
+    glm::mat4 viewProjection;
+    glm::vec3 cameraPos;
+    std::vector<float> depth; // Row-major, WIDTH * HEIGHT.
+    size_t occluderCount;
+};
+
+#endif // OCCLUSION_CULLER_H
@@ -1,16 +1,75 @@
 #include "renderer.h"
 #include "texture_loader.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
 #include "frustum.hpp"
 #include "renderer.h"
 #include "texture_loader.h"
 #include <iostream>
 #include "../../global.h"
+#include "../../world/chunk/mesher/chunk_mesher.h"
+#include "../../utils/radix_sort.h"
+
+namespace {
+
+// Mega buffer pages, in quads (faces for face records). Smaller pages waste
+// less at the end of each mesh but make the page origin table longer.
+constexpr size_t MEGA_PAGE_QUADS = 64;
+constexpr size_t MEGA_INITIAL_PAGES = 2048;
+
+constexpr GLuint FRAME_UNIFORMS_BINDING = 0;
+
+// A chunk is drawn under conditional render once this many queries in a row
+// came back empty, and unconditionally again after the first that didn't, so
+// a chunk flickering at the edge of an occluder stays drawn.
+constexpr uint8_t QUERY_HIDDEN_FRAMES = 3;
+// Chunk boxes are grown by this much so faces on the box don't depth-fight it.
+constexpr float PROXY_MARGIN = 0.05f;
+
+// The draw order is re-keyed once the camera has moved this far, and sorted
+// from scratch past a chunk width; in between the old order is nearly right.
+constexpr float DRAW_ORDER_RESORT_DISTANCE = 2.0f;
+
+// Box around the sections of a chunk that have quads in either pass.
+bool findChunkBounds(const glm::ivec2& chunkPos, const std::array<uint32_t, MeshData::SECTION_COUNT>& solidEnds,
+                     const std::array<uint32_t, MeshData::SECTION_COUNT>& waterEnds, glm::vec3& min, glm::vec3& max) {
+    int lowest = -1;
+    int highest = -1;
+    for (int section = 0; section < MeshData::SECTION_COUNT; ++section) {
+        uint32_t solidBegin = section > 0 ? solidEnds[section - 1] : 0;
+        uint32_t waterBegin = section > 0 ? waterEnds[section - 1] : 0;
+        if (solidEnds[section] > solidBegin || waterEnds[section] > waterBegin) {
+            lowest = lowest < 0 ? section : lowest;
+            highest = section;
+        }
+    }
+    if (lowest < 0) {
+        return false;
+    }
+    float sectionHeight = static_cast<float>(ChunkSection::SIZE);
+    glm::vec3 origin(chunkPos.x * CHUNK_WIDTH, 0.0f, chunkPos.y * CHUNK_DEPTH);
+    min = origin + glm::vec3(0.0f, lowest * sectionHeight, 0.0f) - PROXY_MARGIN;
+    max = origin + glm::vec3(CHUNK_WIDTH, (highest + 1) * sectionHeight, CHUNK_DEPTH) + PROXY_MARGIN;
+    return true;
+}
 
+} // namespace
 
 Renderer::Renderer()
-    : shouldExit(false), textureLoaded(false), objectShader(nullptr), skyboxShader(nullptr) {
+    : quadIndexCapacity(0), objectShader(nullptr), skyboxShader(nullptr), proxyShader(nullptr),
+      proxyVAO(0), proxyVBO(0),
+      megaVAO(0), megaBuffer(0), megaRecords(0), pageOriginBuffer(0), pageOriginTexture(0),
+      occlusionCulling(true), caveCulling(true), horizonCulling(true), occlusionQueries(false), frameIndex(0),
+      drawOrderDirty(true), drawOrderCamera(0.0f),
+      uploadBudget{UPLOAD_BUDGET_KB * 1024, UPLOAD_BUDGET_MS},
+      shouldExit(false), textureLoaded(false) {
     initOpenGL();
+    if (RENDERER_MEGA_BUFFER) {
+        initMegaBuffer();
+    }
     camera = nullptr;
     projection = glm::perspective(
 
@@ -26,15 +85,26 @@ Renderer::~Renderer() {
     for (auto& [chunkPos, mesh] : chunkMeshes) {
         glDeleteVertexArrays(1, &mesh.solidVAO);
         glDeleteBuffers(1, &mesh.solidVBO);
-        glDeleteBuffers(1, &mesh.solidEBO);
         glDeleteVertexArrays(1, &mesh.waterVAO);
         glDeleteBuffers(1, &mesh.waterVBO);
-        glDeleteBuffers(1, &mesh.waterEBO);
+        glDeleteTextures(1, &mesh.solidRecords);
+        glDeleteTextures(1, &mesh.waterRecords);
+        glDeleteQueries(1, &mesh.occlusionQuery);
     }
+    glDeleteVertexArrays(1, &megaVAO);
+    glDeleteBuffers(1, &megaBuffer);
+    glDeleteTextures(1, &megaRecords);
+    glDeleteBuffers(1, &pageOriginBuffer);
+    glDeleteTextures(1, &pageOriginTexture);
+    glDeleteBuffers(1, &frameUniformBuffer);
+    glDeleteBuffers(1, &quadIndexBuffer);
     glDeleteVertexArrays(1, &skyboxVAO);
     glDeleteBuffers(1, &skyboxVBO);
+    glDeleteVertexArrays(1, &proxyVAO);
+    glDeleteBuffers(1, &proxyVBO);
     delete objectShader;
     delete skyboxShader;
+    delete proxyShader;
 
 }
 
@@ -45,6 +115,31 @@ void Renderer::initOpenGL() {
     glfwSwapInterval(0);
     glGenVertexArrays(1, &skyboxVAO);
     glGenBuffers(1, &skyboxVBO);
+    glGenBuffers(1, &quadIndexBuffer);
+    glGenBuffers(1, &frameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, frameUniformBuffer);
+
+    // Unit cube for occlusion query proxies, scaled to each chunk's box.
+    const float cube[] = {
+        0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0, 0,
+        0, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 0, 1,
+        0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 0, 0, 1, 0, 0, 0,
+        1, 0, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 0,
+        0, 0, 0, 1, 0, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, 0, 0, 0,
+        0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 0,
+    };
+    glGenVertexArrays(1, &proxyVAO);
+    glGenBuffers(1, &proxyVBO);
+    glBindVertexArray(proxyVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, proxyVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+
     GLenum err = glGetError();
     if (err != GL_NO_ERROR) {
         std::cerr << "OpenGL error after initialization: " << err << std::endl;
@@ -57,141 +152,331 @@ void Renderer::initShaders() {
     try {
         objectShader = new Shader("../src/shaders/triangle.vert", "../src/shaders/triangle.frag");
         skyboxShader = new Shader("../src/shaders/skybox.vert", "../src/shaders/skybox.frag");
+        proxyShader = new Shader("../src/shaders/occlusion_proxy.vert", "../src/shaders/occlusion_proxy.frag");
     } catch (const std::exception& e) {
         std::cerr << "Shader compilation failed: " << e.what() << std::endl;
         throw;
     }
+
+    objectShader->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    skyboxShader->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+    proxyShader->bindUniformBlock("FrameUniforms", FRAME_UNIFORMS_BINDING);
+
+    // Fixed for the lifetime of the program.
+    objectShader->use();
+    objectShader->setInt("texture1", 0);
+    objectShader->setInt("faceRecords", 1);
+    objectShader->setInt("pageOrigins", 2);
+    objectShader->setInt("meshFormat", CHUNK_MESH_FORMAT);
+    objectShader->setInt("pageQuads", RENDERER_MEGA_BUFFER ? static_cast<int>(MEGA_PAGE_QUADS) : 0);
+    glUseProgram(0);
 }
 
-void Renderer::addChunk(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                        const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices) {
+void Renderer::addChunk(const glm::ivec2& chunkPos, MeshData&& mesh) {
     std::unique_lock<std::mutex> lock(queueMutex);
-    chunkUpdateQueue.push(ChunkUpdate{ChunkUpdateType::Add, chunkPos, solidVertices, solidIndices, waterVertices, waterIndices});
+    chunkUpdateQueue.push_back(ChunkUpdate{ChunkUpdateType::Add, chunkPos, std::move(mesh)});
 }
 
 void Renderer::removeChunk(const glm::ivec2& chunkPos) {
     std::unique_lock<std::mutex> lock(queueMutex);
-    chunkUpdateQueue.push(ChunkUpdate{ChunkUpdateType::Remove, chunkPos, {}, {}});
+    chunkUpdateQueue.push_back(ChunkUpdate{ChunkUpdateType::Remove, chunkPos, {}});
 }
 
-void Renderer::updateChunk(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                           const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices) {
+void Renderer::updateChunk(const glm::ivec2& chunkPos, MeshData&& mesh) {
     std::unique_lock<std::mutex> lock(queueMutex);
-    chunkUpdateQueue.push(ChunkUpdate{ChunkUpdateType::Update, chunkPos, solidVertices, solidIndices, waterVertices, waterIndices});
+    chunkUpdateQueue.push_back(ChunkUpdate{ChunkUpdateType::Update, chunkPos, std::move(mesh)});
 }
 
+// Removals are applied at once; meshes wait in pendingUploads, where a newer
+// mesh for the same chunk replaces the queued one and a removal cancels it.
 void Renderer::processChunkUpdates() {
-    std::queue<ChunkUpdate> updates;
+    incomingUpdates.clear();
     {
         std::unique_lock<std::mutex> lock(queueMutex);
-        std::swap(updates, chunkUpdateQueue);
-    }
-
-    while (!updates.empty()) {
-        const auto& update = updates.front();
-        switch (update.type) {
-            case ChunkUpdateType::Add:
-                addChunkImpl(update.chunkPos, update.solidVertices, update.solidIndices, update.waterVertices, update.waterIndices);
-                break;
-            case ChunkUpdateType::Update:
-                updateChunkImpl(update.chunkPos, update.solidVertices, update.solidIndices, update.waterVertices, update.waterIndices);
-                break;
-            case ChunkUpdateType::Remove:
-                removeChunkImpl(update.chunkPos);
-                break;
+        std::swap(incomingUpdates, chunkUpdateQueue);
+    }
+
+    for (ChunkUpdate& update : incomingUpdates) {
+        if (update.type == ChunkUpdateType::Remove) {
+            cancelUpload(update.chunkPos);
+            removeChunkImpl(update.chunkPos);
+        } else {
+            queueUpload(std::move(update));
         }
-        updates.pop();
     }
+
+    uploadOrder.clear();
+    glm::ivec2 cameraChunk(0);
+    std::unique_ptr<Frustum> frustum;
+    if (camera) {
+        glm::vec3 cameraPos = camera->getPosition();
+        cameraChunk = glm::ivec2(static_cast<int>(std::floor(cameraPos.x / CHUNK_WIDTH)),
+                                 static_cast<int>(std::floor(cameraPos.z / CHUNK_DEPTH)));
+        frustum = std::make_unique<Frustum>(projection * camera->getViewMatrix());
+    }
+    for (const auto& [chunkPos, update] : pendingUploads) {
+        glm::ivec2 offset = chunkPos - cameraChunk;
+        bool visible = !frustum || frustum->isChunkVisible(chunkPos);
+        uploadOrder.push_back(UploadCandidate{chunkPos, visible, offset.x * offset.x + offset.y * offset.y});
+    }
+    std::sort(uploadOrder.begin(), uploadOrder.end());
+
+    auto start = std::chrono::steady_clock::now();
+    size_t uploads = 0;
+    size_t bytes = 0;
+    float milliseconds = 0.0f;
+    for (const UploadCandidate& candidate : uploadOrder) {
+        auto it = pendingUploads.find(candidate.chunkPos);
+        size_t meshBytes = it->second.mesh.byteSize();
+        // Always make progress, even if a single mesh is over budget.
+        if (uploads > 0 && (bytes + meshBytes > uploadBudget.bytes || milliseconds >= uploadBudget.milliseconds)) {
+            break;
+        }
+
+        if (it->second.type == ChunkUpdateType::Add) {
+            addChunkImpl(candidate.chunkPos, it->second.mesh);
+        } else {
+            updateChunkImpl(candidate.chunkPos, it->second.mesh);
+        }
+        releasedMeshes.push_back(std::move(it->second.mesh));
+        pendingUploads.erase(it);
+
+        uploads++;
+        bytes += meshBytes;
+        milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    uploadStats.uploads += uploads;
+    uploadStats.queuedUploads = pendingUploads.size();
+    uploadStats.lastFrameUploads = uploads;
+    uploadStats.lastFrameBytes = bytes;
+    uploadStats.lastFrameMilliseconds = milliseconds;
 }
 
-void Renderer::addChunkImpl(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                            const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices) {
-    ChunkMesh mesh;
+void Renderer::queueUpload(ChunkUpdate&& update) {
+    auto it = pendingUploads.find(update.chunkPos);
+    if (it == pendingUploads.end()) {
+        glm::ivec2 chunkPos = update.chunkPos;
+        pendingUploads.emplace(chunkPos, std::move(update));
+        return;
+    }
+
+    uploadStats.uploadsAvoided++;
+    releasedMeshes.push_back(std::move(it->second.mesh));
+    it->second.mesh = std::move(update.mesh);
+}
+
+void Renderer::cancelUpload(const glm::ivec2& chunkPos) {
+    auto it = pendingUploads.find(chunkPos);
+    if (it == pendingUploads.end()) {
+        return;
+    }
+
+    uploadStats.uploadsAvoided++;
+    releasedMeshes.push_back(std::move(it->second.mesh));
+    pendingUploads.erase(it);
+}
+
+void Renderer::setUploadBudget(const UploadBudget& budget) {
+    uploadBudget = budget;
+}
+
+void Renderer::setOcclusionCulling(bool enabled) {
+    occlusionCulling = enabled;
+}
+
+void Renderer::setCaveCulling(bool enabled) {
+    caveCulling = enabled;
+}
+
+void Renderer::setHorizonCulling(bool enabled) {
+    horizonCulling = enabled;
+}
+
+void Renderer::setOcclusionQueries(bool enabled) {
+    occlusionQueries = enabled;
+}
+
+std::vector<MeshData> Renderer::takeReleasedMeshes() {
+    std::vector<MeshData> released;
+    std::swap(released, releasedMeshes);
+    return released;
+}
+
+UploadStats Renderer::getUploadStats() const {
+    return uploadStats;
+}
+
+CullingStats Renderer::getCullingStats() const {
+    return cullingStats;
+}
+
+void Renderer::addChunkImpl(const glm::ivec2& chunkPos, const MeshData& meshData) {
+    {
+        // Re-adding a chunk reuses its GL objects instead of leaking them.
+        std::unique_lock<std::mutex> lock(chunkMutex);
+        if (chunkMeshes.find(chunkPos) != chunkMeshes.end()) {
+            lock.unlock();
+            updateChunkImpl(chunkPos, meshData);
+            return;
+        }
+    }
+
+    const std::vector<uint32_t>& solidVertices = meshData.solidVertices;
+    const std::vector<uint32_t>& waterVertices = meshData.waterVertices;
+    ChunkMesh mesh{};
+    size_t solidQuads = solidVertices.size() / CHUNK_QUAD_WORDS;
+    size_t waterQuads = waterVertices.size() / CHUNK_QUAD_WORDS;
+    reserveQuadIndices(std::max(solidQuads, waterQuads));
+
+    mesh.solidSectionEnds = meshData.solidSectionEnds;
+    mesh.waterSectionEnds = meshData.waterSectionEnds;
+    mesh.solidLayers = meshData.solidLayers;
+    mesh.sectionConnectivity = meshData.sectionConnectivity;
+
+    if (RENDERER_MEGA_BUFFER) {
+        writeMegaBuffer(mesh.solidAllocation, solidVertices, chunkPos);
+        writeMegaBuffer(mesh.waterAllocation, waterVertices, chunkPos);
+        std::unique_lock<std::mutex> lock(chunkMutex);
+        chunkMeshes[chunkPos] = mesh;
+        drawOrderDirty = true;
+        return;
+    }
 
     // Solid mesh
     glGenVertexArrays(1, &mesh.solidVAO);
     glGenBuffers(1, &mesh.solidVBO);
-    glGenBuffers(1, &mesh.solidEBO);
 
     glBindVertexArray(mesh.solidVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, mesh.solidVBO);
-    glBufferData(GL_ARRAY_BUFFER, solidVertices.size() * sizeof(float), solidVertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, solidVertices.size() * sizeof(uint32_t), solidVertices.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.solidEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, solidIndices.size() * sizeof(unsigned int), solidIndices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(8 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(9 * sizeof(float)));
-    glEnableVertexAttribArray(4);
+    setupVertexAttributes();
 
     glBindVertexArray(0);
 
-    mesh.solidIndexCount = solidIndices.size();
+    mesh.solidRecords = createFaceRecordTexture(mesh.solidVBO);
 
     // Water mesh
     glGenVertexArrays(1, &mesh.waterVAO);
     glGenBuffers(1, &mesh.waterVBO);
-    glGenBuffers(1, &mesh.waterEBO);
 
     glBindVertexArray(mesh.waterVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, mesh.waterVBO);
-    glBufferData(GL_ARRAY_BUFFER, waterVertices.size() * sizeof(float), waterVertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, waterVertices.size() * sizeof(uint32_t), waterVertices.data(), GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.waterEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, waterIndices.size() * sizeof(unsigned int), waterIndices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(8 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(9 * sizeof(float)));
-    glEnableVertexAttribArray(4);
+    setupVertexAttributes();
 
     glBindVertexArray(0);
 
-    mesh.waterIndexCount = waterIndices.size();
+    mesh.waterRecords = createFaceRecordTexture(mesh.waterVBO);
 
     std::unique_lock<std::mutex> lock(chunkMutex);
     chunkMeshes[chunkPos] = mesh;
+    drawOrderDirty = true;
+}
+
+// Grows the shared index buffer to cover quadCount quads. The buffer name
+// never changes, so VAOs that already reference it stay valid.
+void Renderer::reserveQuadIndices(size_t quadCount) {
+    if (FACE_RECORD_MESHES || quadCount <= quadIndexCapacity) {
+        return;
+    }
+
+    quadIndexCapacity = std::max(quadCount, quadIndexCapacity * 2);
+    std::vector<unsigned int> indices(quadIndexCapacity * 6);
+    for (size_t quad = 0; quad < quadIndexCapacity; ++quad) {
+        unsigned int base = static_cast<unsigned int>(quad * 4);
+        unsigned int* quadIndices = &indices[quad * 6];
+        quadIndices[0] = base;
+        quadIndices[1] = base + 1;
+        quadIndices[2] = base + 2;
+        quadIndices[3] = base + 2;
+        quadIndices[4] = base + 3;
+        quadIndices[5] = base;
+    }
+
+    // Upload through a non-VAO binding point so no chunk VAO is modified.
+    glBindBuffer(GL_COPY_WRITE_BUFFER, quadIndexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// Expects the chunk VBO to be bound to GL_ARRAY_BUFFER and its VAO bound.
+void Renderer::setupVertexAttributes() {
+    if (FACE_RECORD_MESHES) {
+        return; // Pulled through a buffer texture; the VAO stays empty.
+    }
+
+    if (CHUNK_MESH_FORMAT == CHUNK_MESH_PACKED) {
+        glVertexAttribIPointer(5, 2, GL_UNSIGNED_INT, CHUNK_VERTEX_WORDS * sizeof(uint32_t), (void*)0);
+        glEnableVertexAttribArray(5);
+        return;
+    }
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_WORDS * sizeof(uint32_t), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_WORDS * sizeof(uint32_t), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_WORDS * sizeof(uint32_t), (void*)(5 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_WORDS * sizeof(uint32_t), (void*)(8 * sizeof(float)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, CHUNK_VERTEX_WORDS * sizeof(uint32_t), (void*)(9 * sizeof(float)));
+    glEnableVertexAttribArray(4);
 }
 
+// Face records are read with texelFetch on a GL_R32UI view of the chunk VBO.
+// The texture follows the buffer object, so re-uploads need no rebinding.
+GLuint Renderer::createFaceRecordTexture(GLuint buffer) {
+    if (!FACE_RECORD_MESHES) {
+        return 0;
+    }
 
-void Renderer::updateChunkImpl(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                               const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    return texture;
+}
+
+void Renderer::updateChunkImpl(const glm::ivec2& chunkPos, const MeshData& meshData) {
+    const std::vector<uint32_t>& solidVertices = meshData.solidVertices;
+    const std::vector<uint32_t>& waterVertices = meshData.waterVertices;
     std::unique_lock<std::mutex> lock(chunkMutex);
     auto it = chunkMeshes.find(chunkPos);
     if (it != chunkMeshes.end()) {
+        size_t solidQuads = solidVertices.size() / CHUNK_QUAD_WORDS;
+        size_t waterQuads = waterVertices.size() / CHUNK_QUAD_WORDS;
+        reserveQuadIndices(std::max(solidQuads, waterQuads));
+        it->second.solidSectionEnds = meshData.solidSectionEnds;
+        it->second.waterSectionEnds = meshData.waterSectionEnds;
+        it->second.solidLayers = meshData.solidLayers;
+        it->second.sectionConnectivity = meshData.sectionConnectivity;
+
+        if (RENDERER_MEGA_BUFFER) {
+            writeMegaBuffer(it->second.solidAllocation, solidVertices, chunkPos);
+            writeMegaBuffer(it->second.waterAllocation, waterVertices, chunkPos);
+            return;
+        }
+
         // Update solid mesh
-        glBindVertexArray(it->second.solidVAO);
         glBindBuffer(GL_ARRAY_BUFFER, it->second.solidVBO);
-        glBufferData(GL_ARRAY_BUFFER, solidVertices.size() * sizeof(float), solidVertices.data(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, it->second.solidEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, solidIndices.size() * sizeof(unsigned int), solidIndices.data(), GL_STATIC_DRAW);
-        it->second.solidIndexCount = solidIndices.size();
+        glBufferData(GL_ARRAY_BUFFER, solidVertices.size() * sizeof(uint32_t), solidVertices.data(), GL_STATIC_DRAW);
 
         // Update water mesh
-        glBindVertexArray(it->second.waterVAO);
         glBindBuffer(GL_ARRAY_BUFFER, it->second.waterVBO);
-        glBufferData(GL_ARRAY_BUFFER, waterVertices.size() * sizeof(float), waterVertices.data(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, it->second.waterEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, waterIndices.size() * sizeof(unsigned int), waterIndices.data(), GL_STATIC_DRAW);
-        it->second.waterIndexCount = waterIndices.size();
+        glBufferData(GL_ARRAY_BUFFER, waterVertices.size() * sizeof(uint32_t), waterVertices.data(), GL_STATIC_DRAW);
     } else {
         lock.unlock();
-        addChunkImpl(chunkPos, solidVertices, solidIndices, waterVertices, waterIndices);
+        addChunkImpl(chunkPos, meshData);
     }
 }
 
@@ -199,15 +484,433 @@ void Renderer::removeChunkImpl(const glm::ivec2& chunkPos) {
     std::unique_lock<std::mutex> lock(chunkMutex);
     auto it = chunkMeshes.find(chunkPos);
     if (it != chunkMeshes.end()) {
+        freeMegaBuffer(it->second.solidAllocation);
+        freeMegaBuffer(it->second.waterAllocation);
+
         glDeleteVertexArrays(1, &it->second.solidVAO);
         glDeleteBuffers(1, &it->second.solidVBO);
-        glDeleteBuffers(1, &it->second.solidEBO);
 
         glDeleteVertexArrays(1, &it->second.waterVAO);
         glDeleteBuffers(1, &it->second.waterVBO);
-        glDeleteBuffers(1, &it->second.waterEBO);
+
+        glDeleteTextures(1, &it->second.solidRecords);
+        glDeleteTextures(1, &it->second.waterRecords);
+        glDeleteQueries(1, &it->second.occlusionQuery);
 
         chunkMeshes.erase(it);
+        drawOrderDirty = true;
+    }
+}
+
+void Renderer::initMegaBuffer() {
+    glGenVertexArrays(1, &megaVAO);
+    glGenBuffers(1, &pageOriginBuffer);
+    glGenTextures(1, &pageOriginTexture);
+    if (FACE_RECORD_MESHES) {
+        glGenTextures(1, &megaRecords);
+    }
+    growMegaBuffer(MEGA_INITIAL_PAGES);
+
+    glBindTexture(GL_TEXTURE_BUFFER, pageOriginTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, pageOriginBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+// Doubles the mega buffer, or more if minPages wouldn't fit otherwise. The old
+// contents are copied on the GPU, so allocations keep their pages.
+void Renderer::growMegaBuffer(size_t minPages) {
+    size_t oldPages = megaAllocator.getCapacity();
+    size_t newPages = std::max(oldPages * 2, oldPages + minPages);
+    size_t pageBytes = MEGA_PAGE_QUADS * CHUNK_QUAD_WORDS * sizeof(uint32_t);
+
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, newPages * pageBytes, nullptr, GL_DYNAMIC_DRAW);
+    if (megaBuffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, megaBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldPages * pageBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &megaBuffer);
+    }
+    megaBuffer = newBuffer;
+    megaAllocator.grow(newPages);
+
+    pageOrigins.resize(newPages, glm::vec2(0.0f));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, pageOriginBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, pageOrigins.size() * sizeof(glm::vec2), pageOrigins.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // The VAO and the record texture still point at the old buffer.
+    glBindVertexArray(megaVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, megaBuffer);
+    setupVertexAttributes();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+    glBindVertexArray(0);
+
+    if (FACE_RECORD_MESHES) {
+        glBindTexture(GL_TEXTURE_BUFFER, megaRecords);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, megaBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+}
+
+// Rewrites a mesh in place when it still fits its pages, giving back any it no
+// longer needs; otherwise moves it to a new range.
+void Renderer::writeMegaBuffer(MeshAllocation& allocation, const std::vector<uint32_t>& words, const glm::ivec2& chunkPos) {
+    size_t quads = words.size() / CHUNK_QUAD_WORDS;
+    size_t pages = (quads + MEGA_PAGE_QUADS - 1) / MEGA_PAGE_QUADS;
+    bool moved = pages > allocation.pages;
+    if (!moved) {
+        megaAllocator.free(allocation.page + pages, allocation.pages - pages);
+    } else {
+        freeMegaBuffer(allocation);
+        if (!megaAllocator.allocate(pages, allocation.page)) {
+            growMegaBuffer(pages);
+            megaAllocator.allocate(pages, allocation.page);
+        }
+    }
+    allocation.pages = pages;
+    allocation.quads = quads;
+    if (quads == 0) {
+        return;
+    }
+
+    size_t pageWords = MEGA_PAGE_QUADS * CHUNK_QUAD_WORDS;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, megaBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.page * pageWords * sizeof(uint32_t),
+                    words.size() * sizeof(uint32_t), words.data());
+
+    if (moved) {
+        glm::vec2 origin(chunkPos.x * CHUNK_WIDTH, chunkPos.y * CHUNK_DEPTH);
+        std::fill(pageOrigins.begin() + allocation.page, pageOrigins.begin() + allocation.page + pages, origin);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, pageOriginBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.page * sizeof(glm::vec2), pages * sizeof(glm::vec2),
+                        &pageOrigins[allocation.page]);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void Renderer::freeMegaBuffer(MeshAllocation& allocation) {
+    megaAllocator.free(allocation.page, allocation.pages);
+    allocation = MeshAllocation();
+}
+
+// Rasterizes every run of solid layers in the frustum as an occluder box.
+void Renderer::addOccluders(const Frustum& frustum) {
+    occlusionCuller.beginFrame(projection * camera->getViewMatrix(), camera->getPosition());
+    for (const auto& [chunkPos, mesh] : chunkMeshes) {
+        glm::vec3 origin(chunkPos.x * CHUNK_WIDTH, 0.0f, chunkPos.y * CHUNK_DEPTH);
+        auto isSolid = [&](int layer) { return (mesh.solidLayers[layer / 64] >> (layer % 64)) & 1; };
+        int y = 0;
+        int height = MeshData::LAYER_WORDS * 64;
+        while (y < height) {
+            if (!isSolid(y)) {
+                y++;
+                continue;
+            }
+            int top = y;
+            while (top < height && isSolid(top)) {
+                top++;
+            }
+
+            glm::vec3 min = origin + glm::vec3(0.0f, y, 0.0f);
+            glm::vec3 max = origin + glm::vec3(CHUNK_WIDTH, top, CHUNK_DEPTH);
+            if (frustum.isBoxVisible(min, max)) {
+                occlusionCuller.addOccluder(min, max);
+            }
+            y = top;
+        }
+    }
+    cullingStats.occluders = occlusionCuller.getOccluderCount();
+}
+
+// Walks out from the camera's section through open space; see CaveCuller.
+void Renderer::findReachableSections(const Frustum& frustum) {
+    glm::vec3 cameraPos = camera->getPosition();
+    glm::ivec2 cameraChunk(static_cast<int>(std::floor(cameraPos.x / CHUNK_WIDTH)),
+                           static_cast<int>(std::floor(cameraPos.z / CHUNK_DEPTH)));
+    caveCuller.beginFrame(cameraChunk, VIEW_DISTANCE + 1);
+    for (const auto& [chunkPos, mesh] : chunkMeshes) {
+        caveCuller.setChunk(chunkPos, mesh.sectionConnectivity);
+    }
+    caveCuller.findReachableSections(cameraPos, frustum);
+    cullingStats.reachableSections = caveCuller.getReachableCount();
+}
+
+// Orders the loaded chunks by horizontal distance from the camera. Adding or
+// removing a chunk rebuilds the list with a radix sort; otherwise it is only
+// re-keyed once the camera has moved, and the nearly sorted list is fixed up
+// with an insertion sort. Expects chunkMutex held.
+void Renderer::updateDrawOrder() {
+    glm::vec3 cameraPos = camera->getPosition();
+    glm::vec2 moved(cameraPos.x - drawOrderCamera.x, cameraPos.z - drawOrderCamera.z);
+    float movedDistance = std::sqrt(moved.x * moved.x + moved.y * moved.y);
+    if (!drawOrderDirty && movedDistance < DRAW_ORDER_RESORT_DISTANCE) {
+        return;
+    }
+
+    bool fullSort = drawOrderDirty || movedDistance > CHUNK_WIDTH;
+    if (drawOrderDirty) {
+        drawOrder.clear();
+        for (auto& [chunkPos, mesh] : chunkMeshes) {
+            drawOrder.push_back(DrawItem{0, chunkPos, &mesh});
+        }
+        drawOrderDirty = false;
+    }
+    drawOrderCamera = cameraPos;
+    for (DrawItem& item : drawOrder) {
+        float dx = (item.chunkPos.x + 0.5f) * CHUNK_WIDTH - cameraPos.x;
+        float dz = (item.chunkPos.y + 0.5f) * CHUNK_DEPTH - cameraPos.z;
+        item.distance = static_cast<uint32_t>(std::min(dx * dx + dz * dz, 4.0e9f));
+    }
+
+    if (fullSort) {
+        radixSort(drawOrder, drawOrderScratch, [](const DrawItem& item) { return item.distance; });
+        return;
+    }
+    for (size_t i = 1; i < drawOrder.size(); ++i) {
+        DrawItem item = drawOrder[i];
+        size_t j = i;
+        while (j > 0 && drawOrder[j - 1].distance > item.distance) {
+            drawOrder[j] = drawOrder[j - 1];
+            --j;
+        }
+        drawOrder[j] = item;
+    }
+}
+
+// Sweeps the solid floors of the loaded chunks into a horizon; see HorizonCuller.
+void Renderer::buildHorizon() {
+    glm::vec3 cameraPos = camera->getPosition();
+    glm::ivec2 cameraChunk(static_cast<int>(std::floor(cameraPos.x / CHUNK_WIDTH)),
+                           static_cast<int>(std::floor(cameraPos.z / CHUNK_DEPTH)));
+    horizonCuller.beginFrame(cameraChunk, VIEW_DISTANCE + 1);
+    for (const auto& [chunkPos, mesh] : chunkMeshes) {
+        horizonCuller.setChunk(chunkPos, findSolidHeight(mesh.solidLayers));
+    }
+    horizonCuller.buildHorizon(cameraPos);
+    cullingStats.horizonOccluders = horizonCuller.getOccluderCount();
+}
+
+// Cheapest test first; the box is within one chunk column.
+bool Renderer::isBoxVisible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max) const {
+    return frustum.isBoxVisible(min, max) && (!horizonCulling || horizonCuller.isBoxVisible(min, max)) &&
+           (!occlusionCulling || occlusionCuller.isBoxVisible(min, max));
+}
+
+// Leaves the chunk's visible quads in visibleRanges; see section_culling.h.
+// Sections must also be reachable when cave culling is on.
+void Renderer::findVisibleSections(const Frustum& frustum, const glm::ivec2& chunkPos, const SectionEnds& sectionEnds,
+                                   bool countStats) {
+    SectionCullResult result = ::findVisibleSections(
+        chunkPos, sectionEnds,
+        [&](int section) { return !caveCulling || caveCuller.isSectionReachable(chunkPos, section); },
+        [&](const glm::vec3& min, const glm::vec3& max) { return isBoxVisible(frustum, min, max); },
+        visibleRanges);
+    if (countStats && result.sections > 0) {
+        cullingStats.chunks++;
+        cullingStats.sections += result.sections;
+        cullingStats.chunksVisible += result.chunkVisible;
+        cullingStats.sectionsVisible += result.sectionsVisible;
+    }
+}
+
+// One multi-draw for every visible section in the pass, solid chunks front to
+// back and water back to front. Expects chunkMutex held.
+void Renderer::drawMegaBuffer(const Frustum& frustum, bool water) {
+    drawCounts.clear();
+    drawFirsts.clear();
+    drawIndexOffsets.clear();
+    for (size_t i = 0; i < drawOrder.size(); ++i) {
+        const DrawItem& item = drawOrder[water ? drawOrder.size() - 1 - i : i];
+        const glm::ivec2& chunkPos = item.chunkPos;
+        ChunkMesh& mesh = *item.mesh;
+        const MeshAllocation& allocation = water ? mesh.waterAllocation : mesh.solidAllocation;
+        if (allocation.quads == 0) {
+            continue;
+        }
+
+        findVisibleSections(frustum, chunkPos, water ? mesh.waterSectionEnds : mesh.solidSectionEnds, !water);
+        if (visibleRanges.empty() || deferToQuery(chunkPos, mesh, water)) {
+            continue;
+        }
+        countDraws(false);
+        appendMegaDraws(allocation);
+    }
+    submitMegaDraws();
+}
+
+// Adds the ranges findVisibleSections left in visibleRanges to the multi-draw.
+void Renderer::appendMegaDraws(const MeshAllocation& allocation) {
+    for (const QuadRange& range : visibleRanges) {
+        size_t firstQuad = allocation.page * MEGA_PAGE_QUADS + range.first;
+        if (FACE_RECORD_MESHES) {
+            drawFirsts.push_back(static_cast<GLint>(firstQuad * 6));
+        } else {
+            drawFirsts.push_back(static_cast<GLint>(firstQuad * 4)); // Base vertex.
+            drawIndexOffsets.push_back(nullptr);
+        }
+        drawCounts.push_back(static_cast<GLsizei>(range.count * 6));
+    }
+}
+
+void Renderer::submitMegaDraws() {
+    if (drawCounts.empty()) {
+        return;
+    }
+
+    glBindVertexArray(megaVAO);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, pageOriginTexture);
+    if (FACE_RECORD_MESHES) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, megaRecords);
+        glActiveTexture(GL_TEXTURE0);
+        glMultiDrawArrays(GL_TRIANGLES, drawFirsts.data(), drawCounts.data(), static_cast<GLsizei>(drawCounts.size()));
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_INT, drawIndexOffsets.data(),
+                                  static_cast<GLsizei>(drawCounts.size()), drawFirsts.data());
+}
+
+void Renderer::countDraws(bool conditional) {
+    for (const QuadRange& range : visibleRanges) {
+        if (conditional) {
+            cullingStats.conditionalTriangles += range.count * 2;
+        } else {
+            cullingStats.draws++;
+            cullingStats.triangles += range.count * 2;
+        }
+    }
+}
+
+// Reads back the queries issued in earlier frames without waiting for any.
+void Renderer::readQueryResults() {
+    for (auto& [chunkPos, mesh] : chunkMeshes) {
+        if (!mesh.queryPending) {
+            continue;
+        }
+        GLuint available = 0;
+        glGetQueryObjectuiv(mesh.occlusionQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+        GLuint samplesPassed = 0;
+        glGetQueryObjectuiv(mesh.occlusionQuery, GL_QUERY_RESULT, &samplesPassed);
+        mesh.queryPending = false;
+        if (samplesPassed) {
+            mesh.emptyQueries = 0;
+        } else if (mesh.emptyQueries < QUERY_HIDDEN_FRAMES) {
+            mesh.emptyQueries++;
+        }
+    }
+}
+
+// Decides how a chunk with visible sections is drawn while occlusion queries
+// are on. The solid pass queues a query for it; the result is read next frame,
+// except for chunks already hidden, whose draws are held back until after the
+// query and made conditional on it. Returns whether the draws are held back.
+bool Renderer::deferToQuery(const glm::ivec2& chunkPos, ChunkMesh& mesh, bool water) {
+    if (!occlusionQueries) {
+        return false;
+    }
+    bool hidden = mesh.emptyQueries >= QUERY_HIDDEN_FRAMES;
+    if (water) {
+        // Only chunks queried in the solid pass have a result to wait for.
+        return hidden && mesh.queryFrame == frameIndex;
+    }
+    if (mesh.queryFrame == frameIndex) {
+        return hidden;
+    }
+
+    // A box around the camera would be clipped by the near plane and could
+    // pass no samples while the chunk fills the screen.
+    glm::vec3 min, max;
+    findChunkBounds(chunkPos, mesh.solidSectionEnds, mesh.waterSectionEnds, min, max);
+    glm::vec3 cameraPos = camera->getPosition();
+    min -= RENDERER_NEAR_PLANE_DISTANCE * 2.0f;
+    max += RENDERER_NEAR_PLANE_DISTANCE * 2.0f;
+    if (cameraPos.x > min.x && cameraPos.y > min.y && cameraPos.z > min.z &&
+        cameraPos.x < max.x && cameraPos.y < max.y && cameraPos.z < max.z) {
+        mesh.emptyQueries = 0;
+        return false;
+    }
+    if (!hidden && mesh.queryPending) {
+        return false; // Still waiting on the last result.
+    }
+
+    mesh.queryFrame = frameIndex;
+    queryChunks.push_back(chunkPos);
+    if (hidden) {
+        hiddenChunks.push_back(chunkPos);
+    }
+    return hidden;
+}
+
+// Draws the boxes of the chunks queued this frame against the depth the solid
+// pass left, counting the samples that pass. Nothing is written.
+void Renderer::issueOcclusionQueries() {
+    if (queryChunks.empty()) {
+        return;
+    }
+
+    proxyShader->use();
+    glBindVertexArray(proxyVAO);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glDepthFunc(GL_LEQUAL);
+    for (const glm::ivec2& chunkPos : queryChunks) {
+        ChunkMesh& mesh = chunkMeshes.find(chunkPos)->second;
+        glm::vec3 min, max;
+        findChunkBounds(chunkPos, mesh.solidSectionEnds, mesh.waterSectionEnds, min, max);
+        if (mesh.occlusionQuery == 0) {
+            glGenQueries(1, &mesh.occlusionQuery);
+        }
+
+        proxyShader->setVec3("boxMin", min);
+        proxyShader->setVec3("boxSize", max - min);
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, mesh.occlusionQuery);
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        mesh.queryPending = true;
+    }
+    cullingStats.queries += queryChunks.size();
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    objectShader->use();
+}
+
+// Draws the chunks held back by deferToQuery, each skipped on the GPU if its
+// query from this frame passed no samples.
+void Renderer::drawHiddenChunks(const Frustum& frustum, bool water) {
+    // Collected front to back in the solid pass.
+    for (size_t i = 0; i < hiddenChunks.size(); ++i) {
+        const glm::ivec2& chunkPos = hiddenChunks[water ? hiddenChunks.size() - 1 - i : i];
+        ChunkMesh& mesh = chunkMeshes.find(chunkPos)->second;
+        findVisibleSections(frustum, chunkPos, water ? mesh.waterSectionEnds : mesh.solidSectionEnds, false);
+        if (visibleRanges.empty()) {
+            continue;
+        }
+        countDraws(true);
+        if (!water) {
+            cullingStats.conditionalChunks++;
+        }
+
+        glBeginConditionalRender(mesh.occlusionQuery, GL_QUERY_WAIT);
+        if (RENDERER_MEGA_BUFFER) {
+            drawCounts.clear();
+            drawFirsts.clear();
+            drawIndexOffsets.clear();
+            appendMegaDraws(water ? mesh.waterAllocation : mesh.solidAllocation);
+            submitMegaDraws();
+        } else {
+            renderChunk(objectShader, water ? mesh.waterVAO : mesh.solidVAO,
+                        water ? mesh.waterRecords : mesh.solidRecords, chunkPos);
+        }
+        glEndConditionalRender();
     }
 }
 
@@ -241,23 +944,56 @@ void Renderer::draw() {
 
     std::unique_lock<std::mutex> lock(chunkMutex);
 
+    updateFrameUniforms(view);
+    cullingStats = CullingStats();
+    frameIndex++;
+    queryChunks.clear();
+    hiddenChunks.clear();
+    if (occlusionQueries) {
+        readQueryResults();
+    }
+    if (occlusionCulling) {
+        addOccluders(frustum);
+    }
+    if (caveCulling) {
+        findReachableSections(frustum);
+    }
+    if (horizonCulling) {
+        buildHorizon();
+    }
+    updateDrawOrder();
+
     // Render voxels
     if (objectShader) {
         objectShader->use();
-        setupShaderUniforms(objectShader, view, projection);
+        glBindTexture(GL_TEXTURE_2D, textureID);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        for (const auto& [chunkPos, mesh] : chunkMeshes) {
-            if (frustum.isChunkVisible(chunkPos)) {
-                renderChunk(objectShader, mesh.solidVAO, mesh.solidIndexCount, chunkPos);
+        for (bool water : {false, true}) {
+            if (RENDERER_MEGA_BUFFER) {
+                drawMegaBuffer(frustum, water);
+            } else {
+                for (size_t i = 0; i < drawOrder.size(); ++i) {
+                    const DrawItem& item = drawOrder[water ? drawOrder.size() - 1 - i : i];
+                    const glm::ivec2& chunkPos = item.chunkPos;
+                    ChunkMesh& mesh = *item.mesh;
+                    findVisibleSections(frustum, chunkPos, water ? mesh.waterSectionEnds : mesh.solidSectionEnds, !water);
+                    if (visibleRanges.empty() || deferToQuery(chunkPos, mesh, water)) {
+                        continue;
+                    }
+                    countDraws(false);
+                    renderChunk(objectShader, water ? mesh.waterVAO : mesh.solidVAO,
+                                water ? mesh.waterRecords : mesh.solidRecords, chunkPos);
+                }
             }
-        }
 
-        for (const auto& [chunkPos, mesh] : chunkMeshes) {
-            if (frustum.isChunkVisible(chunkPos) && mesh.waterIndexCount > 0) {
-                renderChunk(objectShader, mesh.waterVAO, mesh.waterIndexCount, chunkPos);
+            // Queries test against the solid depth only, before any chunk
+            // they may hide is drawn.
+            if (!water) {
+                issueOcclusionQueries();
             }
+            drawHiddenChunks(frustum, water);
         }
         glDisable(GL_BLEND);
         glUseProgram(0);
@@ -268,10 +1004,6 @@ void Renderer::draw() {
     if (skyboxShader) {
         glDepthFunc(GL_LEQUAL);
         skyboxShader->use();
-        glm::mat4 skyboxView = glm::mat4(glm::mat3(view));
-        skyboxShader->setMat4("view", skyboxView);
-        skyboxShader->setMat4("projection", projection);
-        skyboxShader->setFloat("time", static_cast<float>(glfwGetTime()));
         glBindVertexArray(skyboxVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
         glDepthFunc(GL_LESS);
@@ -288,24 +1020,45 @@ void Renderer::draw() {
 }
 
 
-void Renderer::setupShaderUniforms(Shader* shader, const glm::mat4& view, glm::mat4& projection) {
-    shader->setMat4("view", view);
-    shader->setMat4("projection", projection);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    shader->setVec3("lightDir", lightDir);
-    shader->setVec3("cameraPos", camera->getPosition());
-    shader->setVec3("lightColor", glm::vec3(1.0f, 0.9f, 0.8f));
-    shader->setFloat("ambientStrength", 0.2f);
-    shader->setVec3("fogColor", glm::vec3(0.7f, 0.8f, 0.9f));
-    shader->setFloat("fogDensity", 0.002f);
-    shader->setFloat("time", static_cast<float>(glfwGetTime()));
+// One buffer upload per frame instead of a glUniform call per value per program.
+void Renderer::updateFrameUniforms(const glm::mat4& view) {
+    FrameUniforms uniforms{};
+    uniforms.view = view;
+    uniforms.projection = projection;
+    uniforms.cameraPos = glm::vec4(camera->getPosition(), 1.0f);
+    uniforms.lightDir = glm::vec4(lightDir, 0.0f);
+    uniforms.lightColor = glm::vec4(1.0f, 0.9f, 0.8f, 0.2f);
+    uniforms.fogColor = glm::vec4(0.7f, 0.8f, 0.9f, 0.002f);
+    uniforms.time = static_cast<float>(glfwGetTime());
+
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &uniforms);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 
 
-void Renderer::renderChunk(Shader* shader, GLuint vao, int indexCount, const glm::ivec2& chunkPos) {
+// Draws the ranges findVisibleSections left in visibleRanges.
+void Renderer::renderChunk(Shader* shader, GLuint vao, GLuint faceRecords, const glm::ivec2& chunkPos) {
+    if (visibleRanges.empty()) {
+        return;
+    }
+
+    shader->setVec3("chunkOrigin", glm::vec3(chunkPos.x * CHUNK_WIDTH, 0.0f, chunkPos.y * CHUNK_DEPTH));
     glBindVertexArray(vao);
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+    if (FACE_RECORD_MESHES) {
+        // Six vertices per face, expanded from gl_VertexID in triangle.vert.
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_BUFFER, faceRecords);
+        glActiveTexture(GL_TEXTURE0);
+        for (const QuadRange& range : visibleRanges) {
+            glDrawArrays(GL_TRIANGLES, range.first * 6, range.count * 6);
+        }
+        return;
+    }
+    for (const QuadRange& range : visibleRanges) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, range.count * 6, GL_UNSIGNED_INT, nullptr, range.first * 4);
+    }
 }
 
 
@@ -6,8 +6,9 @@
 #include <GLFW/glfw3.h>
 #include <string>
 #include <vector>
+#include <array>
+#include <cstdint>
 #include <unordered_map>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
@@ -15,7 +16,62 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "../camera/camera.h"
 #include "shader.h"
+#include "free_list_allocator.h"
+#include "frustum.hpp"
+#include "occlusion_culler.h"
+#include "cave_culler.h"
+#include "horizon_culler.h"
+#include "section_culling.h"
 #include "../../utils/hash.h"
+#include "../../world/chunk/mesher/mesh_data.h"
+
+struct UploadStats {
+    uint64_t uploads = 0;
+    uint64_t uploadsAvoided = 0; // Superseded by a newer update before upload, or cancelled by a removal.
+    size_t queuedUploads = 0; // Meshes deferred to later frames.
+    size_t lastFrameUploads = 0;
+    size_t lastFrameBytes = 0;
+    float lastFrameMilliseconds = 0.0f;
+};
+
+// Solid pass of the last frame; sections are the non-empty ones.
+struct CullingStats {
+    uint64_t chunks = 0;
+    uint64_t chunksVisible = 0;
+    uint64_t sections = 0;
+    uint64_t sectionsVisible = 0;
+    uint64_t occluders = 0; // Solid slabs rasterized for occlusion culling.
+    uint64_t reachableSections = 0; // Sections the cave culler reached from the camera.
+    uint64_t horizonOccluders = 0; // Chunks that raised the horizon.
+    // Both passes. Draws are quad ranges: one glDraw call each, or one entry of a multi-draw.
+    uint64_t draws = 0;
+    uint64_t triangles = 0;
+    // Occlusion queries; chunks whose last query came back empty are drawn
+    // under conditional render, so the GPU likely skipped these.
+    uint64_t queries = 0;
+    uint64_t conditionalChunks = 0;
+    uint64_t conditionalTriangles = 0;
+};
+
+// Per-frame limits for processChunkUpdates.
+struct UploadBudget {
+    size_t bytes;
+    float milliseconds;
+};
+
+// Mirrors the std140 FrameUniforms block in the shaders: vec3s are padded to
+// vec4 and the spare w carries a scalar where one fits.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 cameraPos;
+    glm::vec4 lightDir;
+    glm::vec4 lightColor; // w: ambient strength
+    glm::vec4 fogColor; // w: fog density
+    float time;
+    float padding[3];
+};
+static_assert(sizeof(FrameUniforms) == 2 * 64 + 4 * 16 + 16, "FrameUniforms must follow std140 layout");
 
 class Renderer {
 public:
@@ -27,12 +83,21 @@ public:
     void setCamera(Camera* camera);
     void setSkyboxData(const std::vector<float>& vertices);
     void loadTexture(const std::string& path);
-    void addChunk(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                  const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices);
-    void updateChunk(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                     const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices);
+    void addChunk(const glm::ivec2& chunkPos, MeshData&& mesh);
+    void updateChunk(const glm::ivec2& chunkPos, MeshData&& mesh);
     void removeChunk(const glm::ivec2& chunkPos);
+    // Applies removals, then uploads queued meshes nearest first, visible
+    // chunks before hidden ones, until the upload budget is spent.
     void processChunkUpdates();
+    void setUploadBudget(const UploadBudget& budget);
+    void setOcclusionCulling(bool enabled);
+    void setCaveCulling(bool enabled);
+    void setHorizonCulling(bool enabled);
+    void setOcclusionQueries(bool enabled);
+    // Meshes the renderer is done with, uploaded or superseded, ready to be recycled.
+    std::vector<MeshData> takeReleasedMeshes();
+    UploadStats getUploadStats() const;
+    CullingStats getCullingStats() const;
     void setLightDir(glm::vec3 dir);
 
 private:
@@ -42,31 +107,102 @@ private:
         Remove
     };
 
+    // A chunk's slice of the mega buffer, in whole pages.
+    struct MeshAllocation {
+        size_t page = 0;
+        size_t pages = 0;
+        size_t quads = 0;
+    };
+
+    using SectionEnds = std::array<uint32_t, MeshData::SECTION_COUNT>;
+
     struct ChunkMesh {
-        GLuint solidVAO, solidVBO, solidEBO;
-        GLuint waterVAO, waterVBO, waterEBO;
-        size_t solidIndexCount;
-        size_t waterIndexCount;
+        MeshAllocation solidAllocation, waterAllocation; // Mega buffer only; the GL names below are 0.
+        SectionEnds solidSectionEnds, waterSectionEnds; // See MeshData.
+        std::array<uint64_t, MeshData::LAYER_WORDS> solidLayers; // Occluder slabs, see MeshData.
+        CaveCuller::Connectivity sectionConnectivity; // See MeshData.
+        GLuint occlusionQuery; // Samples passed by the chunk's box; created on first use.
+        bool queryPending; // Issued and not read back yet.
+        uint8_t emptyQueries; // Consecutive results with no samples passed.
+        uint64_t queryFrame; // Frame the query was last issued in.
+        GLuint solidVAO, solidVBO;
+        GLuint waterVAO, waterVBO;
+        GLuint solidRecords, waterRecords; // Buffer textures over the VBOs; face records only.
     };
 
     struct ChunkUpdate {
         ChunkUpdateType type;
         glm::ivec2 chunkPos;
-        std::vector<float> solidVertices;
-        std::vector<unsigned int> solidIndices;
-        std::vector<float> waterVertices;
-        std::vector<unsigned int> waterIndices;
+        MeshData mesh;
+    };
+
+    // A loaded chunk in the draw order. Map nodes stay put until erased, and
+    // erasing rebuilds the order, so the pointer is safe while chunkMutex is held.
+    struct DrawItem {
+        uint32_t distance; // Squared, in blocks, to the chunk's centre.
+        glm::ivec2 chunkPos;
+        ChunkMesh* mesh;
+    };
+
+    struct UploadCandidate {
+        glm::ivec2 chunkPos;
+        bool visible;
+        int distance; // Squared, in chunks.
+
+        bool operator<(const UploadCandidate& other) const {
+            if (visible != other.visible) {
+                return visible;
+            }
+            return distance < other.distance;
+        }
     };
 
 
     std::unordered_map<glm::ivec2, ChunkMesh, IVec2Hash> chunkMeshes;
     unsigned int skyboxVAO, skyboxVBO;
+    GLuint frameUniformBuffer;
+    GLuint quadIndexBuffer; // 0,1,2,2,3,0 + 4k for every quad; shared by all chunk VAOs.
+    size_t quadIndexCapacity; // In quads.
     unsigned int textureID;
     Shader* objectShader;
     Shader* skyboxShader;
+    Shader* proxyShader; // Chunk boxes for occlusion queries.
+    GLuint proxyVAO, proxyVBO; // Unit cube.
     Camera* camera;
     glm::mat4 projection;
-    std::queue<ChunkUpdate> chunkUpdateQueue;
+    // Mega buffer: mesh words for every chunk, sub-allocated in pages. Each page
+    // holds quads of a single chunk, so the shader finds the chunk origin from
+    // gl_VertexID through pageOrigins.
+    GLuint megaVAO, megaBuffer, megaRecords;
+    GLuint pageOriginBuffer, pageOriginTexture;
+    FreeListAllocator megaAllocator; // In pages.
+    std::vector<glm::vec2> pageOrigins; // Chunk origin x and z per page.
+    std::vector<GLsizei> drawCounts; // Multi-draw arguments, rebuilt every pass.
+    std::vector<GLint> drawFirsts;
+    std::vector<const void*> drawIndexOffsets;
+    std::vector<QuadRange> visibleRanges; // Sections of one chunk that passed culling.
+    CullingStats cullingStats;
+    OcclusionCuller occlusionCuller;
+    bool occlusionCulling;
+    CaveCuller caveCuller;
+    bool caveCulling;
+    HorizonCuller horizonCuller;
+    bool horizonCulling;
+    bool occlusionQueries;
+    uint64_t frameIndex;
+    std::vector<glm::ivec2> queryChunks; // Chunks to query this frame, after the solid pass.
+    std::vector<glm::ivec2> hiddenChunks; // Drawn under conditional render on this frame's query.
+    std::vector<DrawItem> drawOrder; // Nearest first; reused across frames.
+    std::vector<DrawItem> drawOrderScratch;
+    bool drawOrderDirty; // A chunk was added or removed.
+    glm::vec3 drawOrderCamera; // Camera position drawOrder is sorted for.
+    std::vector<ChunkUpdate> chunkUpdateQueue;
+    std::vector<ChunkUpdate> incomingUpdates; // Reused by processChunkUpdates.
+    std::unordered_map<glm::ivec2, ChunkUpdate, IVec2Hash> pendingUploads; // Newest mesh per chunk.
+    std::vector<UploadCandidate> uploadOrder;
+    std::vector<MeshData> releasedMeshes;
+    UploadStats uploadStats;
+    UploadBudget uploadBudget;
     std::mutex queueMutex;
     std::mutex chunkMutex;
     std::mutex textureMutex;
@@ -76,13 +212,35 @@ private:
     glm::vec3 lightDir;
 
     void initOpenGL();
-    void addChunkImpl(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                      const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices);
-    void updateChunkImpl(const glm::ivec2& chunkPos, const std::vector<float>& solidVertices, const std::vector<unsigned int>& solidIndices,
-                         const std::vector<float>& waterVertices, const std::vector<unsigned int>& waterIndices);
+    void queueUpload(ChunkUpdate&& update);
+    void cancelUpload(const glm::ivec2& chunkPos);
+    void addChunkImpl(const glm::ivec2& chunkPos, const MeshData& mesh);
+    void updateChunkImpl(const glm::ivec2& chunkPos, const MeshData& mesh);
     void removeChunkImpl(const glm::ivec2& chunkPos);
-    void setupShaderUniforms(Shader* shader, const glm::mat4& view, glm::mat4& projection);
-    void renderChunk(Shader* shader, GLuint vao, int indexCount, const glm::ivec2& chunkPos);
+    void initMegaBuffer();
+    void growMegaBuffer(size_t minPages);
+    void writeMegaBuffer(MeshAllocation& allocation, const std::vector<uint32_t>& words, const glm::ivec2& chunkPos);
+    void freeMegaBuffer(MeshAllocation& allocation);
+    void drawMegaBuffer(const Frustum& frustum, bool water);
+    void addOccluders(const Frustum& frustum);
+    void findReachableSections(const Frustum& frustum);
+    void buildHorizon();
+    void updateDrawOrder();
+    void readQueryResults();
+    bool deferToQuery(const glm::ivec2& chunkPos, ChunkMesh& mesh, bool water);
+    void issueOcclusionQueries();
+    void drawHiddenChunks(const Frustum& frustum, bool water);
+    void countDraws(bool conditional);
+    void appendMegaDraws(const MeshAllocation& allocation);
+    void submitMegaDraws();
+    bool isBoxVisible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max) const;
+    void findVisibleSections(const Frustum& frustum, const glm::ivec2& chunkPos, const SectionEnds& sectionEnds,
+                             bool countStats);
+    void reserveQuadIndices(size_t quadCount);
+    void setupVertexAttributes();
+    GLuint createFaceRecordTexture(GLuint buffer);
+    void updateFrameUniforms(const glm::mat4& view);
+    void renderChunk(Shader* shader, GLuint vao, GLuint faceRecords, const glm::ivec2& chunkPos);
 
 };
 
@@ -0,0 +1,79 @@
+#ifndef SECTION_CULLING_H
+#define SECTION_CULLING_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../../global.h"
+#include "../../world/chunk/chunk_section.h"
+
+// Quads drawn together, relative to the start of the chunk's mesh.
+struct QuadRange {
+    uint32_t first;
+    uint32_t count;
+};
+
+// What findVisibleSections saw of one chunk; sections are the non-empty ones.
+struct SectionCullResult {
+    uint64_t sections = 0;
+    uint64_t sectionsVisible = 0;
+    bool chunkVisible = false;
+};
+
+// Collects the quads of a chunk's non-empty sections that pass both tests,
+// merging neighbouring sections into one range. sectionEnds is laid out as in
+// MeshData. The box around all non-empty sections is tested first, so a
+// hidden chunk costs one box test. isSectionVisible(section) is checked
+// before isBoxVisible(min, max), which is meant to hold the costlier tests.
+// Kept free of GL so the culling can be tested on its own.
+template <size_t SectionCount, typename SectionTest, typename BoxTest>
+SectionCullResult findVisibleSections(const glm::ivec2& chunkPos, const std::array<uint32_t, SectionCount>& sectionEnds,
+                                      SectionTest isSectionVisible, BoxTest isBoxVisible, std::vector<QuadRange>& ranges) {
+    SectionCullResult result;
+    ranges.clear();
+
+    int lowest = -1;
+    int highest = -1;
+    for (int section = 0; section < static_cast<int>(SectionCount); ++section) {
+        uint32_t begin = section > 0 ? sectionEnds[section - 1] : 0;
+        if (sectionEnds[section] > begin) {
+            lowest = lowest < 0 ? section : lowest;
+            highest = section;
+            result.sections++;
+        }
+    }
+    if (lowest < 0) {
+        return result;
+    }
+
+    float sectionHeight = static_cast<float>(ChunkSection::SIZE);
+    glm::vec3 origin(chunkPos.x * CHUNK_WIDTH, 0.0f, chunkPos.y * CHUNK_DEPTH);
+    glm::vec3 chunkMin = origin + glm::vec3(0.0f, lowest * sectionHeight, 0.0f);
+    glm::vec3 chunkMax = origin + glm::vec3(CHUNK_WIDTH, (highest + 1) * sectionHeight, CHUNK_DEPTH);
+    if (!isBoxVisible(chunkMin, chunkMax)) {
+        return result;
+    }
+    result.chunkVisible = true;
+
+    glm::vec3 sectionSize(CHUNK_WIDTH, sectionHeight, CHUNK_DEPTH);
+    for (int section = lowest; section <= highest; ++section) {
+        uint32_t begin = section > 0 ? sectionEnds[section - 1] : 0;
+        uint32_t end = sectionEnds[section];
+        glm::vec3 sectionMin = origin + glm::vec3(0.0f, section * sectionHeight, 0.0f);
+        if (end == begin || !isSectionVisible(section) || !isBoxVisible(sectionMin, sectionMin + sectionSize)) {
+            continue;
+        }
+        result.sectionsVisible++;
+
+        if (!ranges.empty() && ranges.back().first + ranges.back().count == begin) {
+            ranges.back().count += end - begin;
+        } else {
+            ranges.push_back(QuadRange{begin, end - begin});
+        }
+    }
+    return result;
+}
+
+#endif // SECTION_CULLING_H
@@ -19,6 +19,43 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    cacheUniformLocations();
+}
+
+// Block members are reported too, with location -1; they are set through the
+// block's buffer instead.
+void Shader::cacheUniformLocations() {
+    GLint uniformCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::string name(static_cast<size_t>(maxNameLength), '\0');
+    for (GLint i = 0; i < uniformCount; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), maxNameLength, &length, &size, &type, name.data());
+        std::string uniformName(name.data(), static_cast<size_t>(length));
+        GLint location = glGetUniformLocation(ID, uniformName.c_str());
+        // Arrays are reported as "name[0]"; callers use the bare name.
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            uniformName.resize(uniformName.size() - 3);
+        }
+        uniformLocations[uniformName] = location;
+    }
+}
+
+GLint Shader::getUniformLocation(std::string_view name) const {
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+void Shader::bindUniformBlock(const char* name, GLuint binding) const {
+    GLuint blockIndex = glGetUniformBlockIndex(ID, name);
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(ID, blockIndex, binding);
+    }
 }
 
 void Shader::use() const {
@@ -29,24 +66,24 @@ unsigned int Shader::getID() const {
     return ID;
 }
 
-void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+void Shader::setMat4(std::string_view name, const glm::mat4 &mat) const {
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
 }
 
-void Shader::setVec3(const std::string &name, const glm::vec3 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+void Shader::setVec3(std::string_view name, const glm::vec3 &value) const {
+    glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
-void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+void Shader::setVec2(std::string_view name, const glm::vec2 &value) const {
+    glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
-void Shader::setFloat(const std::string &name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setFloat(std::string_view name, float value) const {
+    glUniform1f(getUniformLocation(name), value);
 }
 
-void Shader::setInt(const std::string &name, int value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::setInt(std::string_view name, int value) const {
+    glUniform1i(getUniformLocation(name), value);
 }
 
 std::string Shader::readFile(const std::string& filePath) {
@@ -4,20 +4,37 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
+// Uniform locations are looked up once after linking; the setters find them
+// by name without calling into GL or allocating. Names the program doesn't
+// use map to -1, which GL ignores.
 class Shader {
 public:
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
     void use() const;
     unsigned int getID() const;
-    void setMat4(const std::string &name, const glm::mat4 &mat) const;
-    void setVec3(const std::string &name, const glm::vec3 &value) const;
-    void setVec2(const std::string &name, const glm::vec2 &value) const;
-    void setFloat(const std::string &name, float value) const;
-    void setInt(const std::string &name, int value) const;
+    GLint getUniformLocation(std::string_view name) const;
+    // GLSL 330 has no layout(binding), so blocks are bound from here.
+    void bindUniformBlock(const char* name, GLuint binding) const;
+    void setMat4(std::string_view name, const glm::mat4 &mat) const;
+    void setVec3(std::string_view name, const glm::vec3 &value) const;
+    void setVec2(std::string_view name, const glm::vec2 &value) const;
+    void setFloat(std::string_view name, float value) const;
+    void setInt(std::string_view name, int value) const;
 
 private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>()(name);
+        }
+    };
+
     unsigned int ID;
+    std::unordered_map<std::string, GLint, NameHash, std::equal_to<>> uniformLocations;
+    void cacheUniformLocations();
     std::string readFile(const std::string& filePath);
     unsigned int createShader(const std::string& source, GLenum shaderType);
     void checkCompileErrors(unsigned int shader, const std::string& type);
@@ -1,5 +1,6 @@
 #define GL_SILENCE_DEPRECATION
 #include "gui.h"
+#include "../../../global.h"
 #include <sstream>
 #include <iomanip>
 #include <glm/trigonometric.hpp>
@@ -17,6 +18,13 @@ void GUI::Init(GLFWwindow* window) {
 
     azimuth = 45.0f;
     altitude = 20.0f;
+    meshingMode = static_cast<int>(MeshingMode::PER_FACE);
+    uploadBudgetKB = UPLOAD_BUDGET_KB;
+    uploadBudgetMs = UPLOAD_BUDGET_MS;
+    occlusionCulling = true;
+    caveCulling = true;
+    horizonCulling = true;
+    occlusionQueries = false;
 
     float crosshairVertices[] = {
         -0.01f, 0.0f, 0.0f,
@@ -85,7 +93,8 @@ void GUI::render() {
 }
 
 
-void GUI::displayInfo(float fps, const glm::vec3& playerPos, int viewDistance, int loadedChunks) {
+void GUI::displayInfo(float fps, const glm::vec3& playerPos, int viewDistance, int loadedChunks, size_t chunkMemory,
+                      const MeshingStats& meshingStats, const UploadStats& uploadStats, const CullingStats& cullingStats) {
     ImGui::SetNextWindowPos(ImVec2(10, 10));
     ImGui::SetNextWindowBgAlpha(0.35f);
     ImGui::Begin("Game Info", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
@@ -96,7 +105,12 @@ void GUI::displayInfo(float fps, const glm::vec3& playerPos, int viewDistance, i
     ImGui::Separator();
     displayPlayerInfo(playerPos);
     ImGui::Separator();
-    displayWorldInfo(viewDistance, loadedChunks);
+    displayWorldInfo(viewDistance, loadedChunks, chunkMemory);
+    ImGui::Separator();
+    displayMeshingInfo(meshingStats);
+    displayUploadInfo(uploadStats);
+    ImGui::Separator();
+    displayCullingInfo(cullingStats);
     ImGui::Separator();
     displayLightDirectionSlider();
 
@@ -114,9 +128,60 @@ void GUI::displayPlayerInfo(const glm::vec3& playerPos) {
     ImGui::Text("%s", oss.str().c_str());
 }
 
-void GUI::displayWorldInfo(int viewDistance, int loadedChunks) {
+void GUI::displayWorldInfo(int viewDistance, int loadedChunks, size_t chunkMemory) {
     ImGui::Text("View Distance: %d chunks", viewDistance);
     ImGui::Text("Loaded Chunks: %d", loadedChunks);
+    ImGui::Text("Chunk Memory: %.1f MB", chunkMemory / (1024.0f * 1024.0f));
+}
+
+void GUI::displayMeshingInfo(const MeshingStats& meshingStats) {
+    const char* modes[] = {"Per-face", "Greedy", "Binary", "Binary greedy"};
+    ImGui::Combo("Meshing", &meshingMode, modes, IM_ARRAYSIZE(modes));
+
+    // Averages since the mode was last changed.
+    uint64_t meshes = meshingStats.meshes > 0 ? meshingStats.meshes : 1;
+    ImGui::Text("Meshes Built: %llu", static_cast<unsigned long long>(meshingStats.meshes));
+    ImGui::Text("Avg Quads: %llu", static_cast<unsigned long long>(meshingStats.quads / meshes));
+    ImGui::Text("Avg Mesh Size: %.1f KB", meshingStats.bytes / (1024.0f * meshes));
+    ImGui::Text("Avg Mesh Time: %.2f ms", meshingStats.microseconds / (1000.0f * meshes));
+    ImGui::Text("Pool Misses: %llu, Buffer Growths: %llu", static_cast<unsigned long long>(meshingStats.poolMisses),
+                static_cast<unsigned long long>(meshingStats.bufferGrowths));
+
+    // Since startup; stays near 1 unless chunk borders change or the mode does.
+    uint64_t chunksLoaded = meshingStats.chunksLoaded > 0 ? meshingStats.chunksLoaded : 1;
+    ImGui::Text("Meshes per Chunk: %.2f", static_cast<float>(meshingStats.totalMeshes) / chunksLoaded);
+    ImGui::Text("Remeshes: %llu", static_cast<unsigned long long>(meshingStats.remeshes));
+}
+
+void GUI::displayUploadInfo(const UploadStats& uploadStats) {
+    ImGui::Text("Chunk Uploads: %llu", static_cast<unsigned long long>(uploadStats.uploads));
+    ImGui::Text("Uploads Avoided: %llu", static_cast<unsigned long long>(uploadStats.uploadsAvoided));
+    ImGui::Text("Upload Queue: %zu", uploadStats.queuedUploads);
+    ImGui::Text("Last Frame: %zu meshes, %.1f KB, %.2f ms", uploadStats.lastFrameUploads,
+                uploadStats.lastFrameBytes / 1024.0f, uploadStats.lastFrameMilliseconds);
+    ImGui::SliderInt("Upload Budget (KB)", &uploadBudgetKB, 64, 16384);
+    ImGui::SliderFloat("Upload Budget (ms)", &uploadBudgetMs, 0.25f, 16.0f);
+}
+
+void GUI::displayCullingInfo(const CullingStats& cullingStats) {
+    ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+    ImGui::Text("Occluders: %llu", static_cast<unsigned long long>(cullingStats.occluders));
+    ImGui::Checkbox("Cave Culling", &caveCulling);
+    ImGui::Text("Reachable Sections: %llu", static_cast<unsigned long long>(cullingStats.reachableSections));
+    ImGui::Checkbox("Horizon Culling", &horizonCulling);
+    ImGui::Text("Horizon Occluders: %llu", static_cast<unsigned long long>(cullingStats.horizonOccluders));
+    ImGui::Text("Visible Chunks: %llu / %llu", static_cast<unsigned long long>(cullingStats.chunksVisible),
+                static_cast<unsigned long long>(cullingStats.chunks));
+    ImGui::Text("Visible Sections: %llu / %llu", static_cast<unsigned long long>(cullingStats.sectionsVisible),
+                static_cast<unsigned long long>(cullingStats.sections));
+    ImGui::Checkbox("Occlusion Queries", &occlusionQueries);
+    ImGui::Text("Queries: %llu", static_cast<unsigned long long>(cullingStats.queries));
+    ImGui::Text("Conditional: %llu chunks, %llu triangles",
+                static_cast<unsigned long long>(cullingStats.conditionalChunks),
+                static_cast<unsigned long long>(cullingStats.conditionalTriangles));
+    // With every culling option off this is the frustum-only baseline.
+    ImGui::Text("Draws: %llu, Triangles: %llu", static_cast<unsigned long long>(cullingStats.draws),
+                static_cast<unsigned long long>(cullingStats.triangles));
 }
 
 void GUI::displayLightDirectionSlider() {
@@ -142,3 +207,27 @@ void GUI::drawCrosshair() {
     glBindVertexArray(crosshairVAO);
     glDrawArrays(GL_LINES, 0, 4);
 }
+
+MeshingMode GUI::getMeshingMode() const {
+    return static_cast<MeshingMode>(meshingMode);
+}
+
+bool GUI::getOcclusionCulling() const {
+    return occlusionCulling;
+}
+
+bool GUI::getCaveCulling() const {
+    return caveCulling;
+}
+
+bool GUI::getHorizonCulling() const {
+    return horizonCulling;
+}
+
+bool GUI::getOcclusionQueries() const {
+    return occlusionQueries;
+}
+
+UploadBudget GUI::getUploadBudget() const {
+    return UploadBudget{static_cast<size_t>(uploadBudgetKB) * 1024, uploadBudgetMs};
+}
@@ -7,6 +7,8 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 #include <glm/glm.hpp>
+#include "../../../world/chunk/mesher/chunk_mesher.h"
+#include "../../renderer/renderer.h"
 
 class GUI {
 public:
@@ -18,18 +20,35 @@ public:
 
     void newFrame();
     void render();
-    void displayInfo(float fps, const glm::vec3& playerPos, int viewDistance, int loadedChunks);
+    void displayInfo(float fps, const glm::vec3& playerPos, int viewDistance, int loadedChunks, size_t chunkMemory,
+                     const MeshingStats& meshingStats, const UploadStats& uploadStats, const CullingStats& cullingStats);
     glm::vec3 getLightDirection();
+    MeshingMode getMeshingMode() const;
+    UploadBudget getUploadBudget() const;
+    bool getOcclusionCulling() const;
+    bool getCaveCulling() const;
+    bool getHorizonCulling() const;
+    bool getOcclusionQueries() const;
     void drawCrosshair();
 
 private:
     void displayFPS(float fps);
     void displayPlayerInfo(const glm::vec3& playerPos);
-    void displayWorldInfo(int viewDistance, int loadedChunks);
+    void displayWorldInfo(int viewDistance, int loadedChunks, size_t chunkMemory);
+    void displayMeshingInfo(const MeshingStats& meshingStats);
+    void displayUploadInfo(const UploadStats& uploadStats);
+    void displayCullingInfo(const CullingStats& cullingStats);
     void displayLightDirectionSlider();
 
     float azimuth;
     float altitude;
+    int meshingMode;
+    int uploadBudgetKB;
+    float uploadBudgetMs;
+    bool occlusionCulling;
+    bool caveCulling;
+    bool horizonCulling;
+    bool occlusionQueries;
     GLuint crosshairVAO, crosshairVBO;
     GLuint crosshairShaderProgram;
 };
@@ -2,7 +2,7 @@
 #include "engine/camera/camera.h"
 
 
-Game::Game(unsigned int seed)
+Game::Game(unsigned int seed, size_t workerCount)
     : window(WINDOW_WIDTH, WINDOW_HEIGHT, "OpenGL Window"),
       player(new Camera(glm::vec3(0.0f, 128.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f), &chunkManager),
       seed(seed),
@@ -11,9 +11,10 @@ Game::Game(unsigned int seed)
       lastFrame(0.0),
       frameCount(0),
       fps(0.0f),
-      lastFPSPrintTime(0.0)
+      lastFPSPrintTime(0.0),
+      memoryUsage(0)
 {
-    chunkManager.init(seed);
+    chunkManager.init(seed, workerCount);
     initialize();
 }
 
@@ -54,29 +55,48 @@ void Game::run() {
             lastUpdatePosition = currentPlayerPos;
         }
 
-        std::tuple<glm::ivec2, std::vector<float>, std::vector<unsigned int>, std::vector<float>, std::vector<unsigned int>> item;
+        chunkManager.setMeshingMode(gui.getMeshingMode());
         chunkManager.updateChunks();
-        while (chunkManager.getRenderQueue().tryPop(item)) {
-            const auto& [chunkPos, solidVertices, solidIndices, waterVertices, waterIndices] = item;
-            if ((!solidVertices.empty() && !solidIndices.empty()) || (!waterVertices.empty() && !waterIndices.empty())) {
-                renderer.addChunk(chunkPos, solidVertices, solidIndices, waterVertices, waterIndices);
+        for (const glm::ivec2& chunkPos : chunkManager.takeUnloadedChunks()) {
+            renderer.removeChunk(chunkPos);
+        }
+
+        meshUpdates.clear();
+        chunkManager.getRenderQueue().popBatch(meshUpdates, RENDER_QUEUE_CAPACITY);
+        for (auto& [chunkPos, mesh] : meshUpdates) {
+            if (!chunkManager.isChunkLoaded(chunkPos)) {
+                chunkManager.recycleMesh(std::move(mesh));
+            } else if (!mesh.empty()) {
+                renderer.addChunk(chunkPos, std::move(mesh));
             } else {
                 renderer.removeChunk(chunkPos);
+                chunkManager.recycleMesh(std::move(mesh));
             }
         }
 
+        renderer.setUploadBudget(gui.getUploadBudget());
         renderer.processChunkUpdates();
+        for (MeshData& mesh : renderer.takeReleasedMeshes()) {
+            chunkManager.recycleMesh(std::move(mesh));
+        }
         renderer.setLightDir(gui.getLightDirection());
+        renderer.setOcclusionCulling(gui.getOcclusionCulling());
+        renderer.setCaveCulling(gui.getCaveCulling());
+        renderer.setHorizonCulling(gui.getHorizonCulling());
+        renderer.setOcclusionQueries(gui.getOcclusionQueries());
 
         frameCount++;
         if (currentFrame - lastFPSPrintTime >= 1.0) {
             fps = frameCount / (currentFrame - lastFPSPrintTime);
             frameCount = 0;
             lastFPSPrintTime = currentFrame;
+            memoryUsage = chunkManager.getMemoryUsage();
         }
 
         gui.newFrame();
-        gui.displayInfo(fps, player.getPosition(), VIEW_DISTANCE, chunkManager.getLoadedChunksCount());
+        gui.displayInfo(fps, player.getPosition(), VIEW_DISTANCE, chunkManager.getLoadedChunksCount(), memoryUsage,
+                        chunkManager.getMeshingStats(), renderer.getUploadStats(),
+                        renderer.getCullingStats());
         renderer.draw();
         gui.render();
         gui.drawCrosshair();
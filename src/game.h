@@ -16,7 +16,7 @@
 
 class Game {
 public:
-    Game(unsigned int seed);
+    Game(unsigned int seed, size_t workerCount = 0);
     void run();
 private:
     void initialize();
@@ -27,11 +27,13 @@ private:
     ChunkManager chunkManager;
     Renderer renderer;
     GUI gui;
+    std::vector<ChunkMeshUpdate> meshUpdates; // Reused every frame.
     glm::vec3 lastUpdatePosition;
     double lastFrame;
     int frameCount;
     float fps;
     double lastFPSPrintTime;
+    size_t memoryUsage; // Chunk voxel memory, sampled with the FPS; it locks every chunk.
 
     unsigned int seed;
 };
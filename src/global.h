@@ -15,6 +15,23 @@
 
 #define VIEW_DISTANCE 16
 
+// Default per-frame limits for chunk mesh uploads; tunable from the GUI. At
+// least one mesh is uploaded every frame, whatever its size.
+#define UPLOAD_BUDGET_KB 1024
+#define UPLOAD_BUDGET_MS 2.0f
+
+// Chunk mesh layouts, see chunk_mesher.h. Float and packed meshes are four
+// vertices per quad; face records are one 32-bit word per face, expanded into
+// a quad in triangle.vert.
+#define CHUNK_MESH_FLOAT 0
+#define CHUNK_MESH_PACKED 1
+#define CHUNK_MESH_FACE_RECORDS 2
+#define CHUNK_MESH_FORMAT CHUNK_MESH_PACKED
+
+// 1: all chunk meshes share one buffer and VAO and each pass is a single
+// multi-draw. 0: every chunk has its own VAO and buffer and is drawn alone.
+#define RENDERER_MEGA_BUFFER 1
+
 // #define DEBUG_MODE
 
 
@@ -3,6 +3,12 @@
 #include <exception>
 #include <cstdlib>
 #include <ctime>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <thread>
+#include <limits>
 
 int main(int argc, char *argv[]) {
 
@@ -26,8 +32,35 @@ int main(int argc, char *argv[]) {
         std::cout << "Using seed: " << seed << std::endl;
     }
 
+    // Optional second argument: chunk worker threads, clamped to
+    // 1..2 * hardware threads. Without it the job system picks one per core.
+    size_t workerCount = 0;
+    if (argc > 2) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        size_t maxWorkers = 2 * static_cast<size_t>(hardwareThreads > 0 ? hardwareThreads : 4);
+        std::string arg = argv[2];
+        bool isNumber = !arg.empty() && std::all_of(arg.begin(), arg.end(), [](unsigned char c) {
+            return std::isdigit(c);
+        });
+        if (!isNumber) {
+            std::cerr << "Invalid worker count. Using one per core." << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [seed] [workers 1.." << maxWorkers << "]" << std::endl;
+        } else {
+            unsigned long value;
+            try {
+                value = std::stoul(arg);
+            } catch (const std::out_of_range& e) {
+                value = std::numeric_limits<unsigned long>::max();
+            }
+            workerCount = static_cast<size_t>(std::clamp<unsigned long>(value, 1, maxWorkers));
+            if (workerCount != value) {
+                std::cerr << "Worker count must be 1.." << maxWorkers << ". Using " << workerCount << "." << std::endl;
+            }
+        }
+    }
+
     try {
-        Game game(seed);
+        Game game(seed, workerCount);
         game.run();
     }
     catch (const std::exception& e) {
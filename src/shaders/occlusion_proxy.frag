@@ -0,0 +1,8 @@
+#version 330 core
+out vec4 FragColor;
+
+// Colour writes are masked off; only the samples passed are counted.
+void main()
+{
+    FragColor = vec4(1.0);
+}
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec3 aPos; // Unit cube corner.
+
+// Per-frame state shared by all programs; must match FrameUniforms in renderer.h.
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+    vec4 lightDir;
+    vec4 lightColor; // w: ambient strength
+    vec4 fogColor; // w: fog density
+    float time;
+};
+
+// The chunk box being tested for occlusion.
+uniform vec3 boxMin;
+uniform vec3 boxSize;
+
+void main()
+{
+    gl_Position = projection * view * vec4(boxMin + aPos * boxSize, 1.0);
+}
@@ -1,7 +1,17 @@
 #version 330 core
 out vec4 FragColor;
 in vec3 TexCoords;
-uniform float time;
+
+// Per-frame state shared by all programs; must match FrameUniforms in renderer.h.
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+    vec4 lightDir;
+    vec4 lightColor; // w: ambient strength
+    vec4 fogColor; // w: fog density
+    float time;
+};
 
 // Improved hash function
 vec3 hash3(vec3 p) {
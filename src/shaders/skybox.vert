@@ -1,14 +1,24 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame state shared by all programs; must match FrameUniforms in renderer.h.
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+    vec4 lightDir;
+    vec4 lightColor; // w: ambient strength
+    vec4 fogColor; // w: fog density
+    float time;
+};
 
 out vec3 TexCoords;
 
 void main()
 {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    // Rotation only, so the sky stays centred on the camera.
+    mat4 skyboxView = mat4(mat3(view));
+    vec4 pos = projection * skyboxView * vec4(aPos, 1.0);
     gl_Position = pos.xyww;  // Use xyww to keep the skybox at a constant distance
 }
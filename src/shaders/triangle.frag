@@ -19,38 +19,49 @@ const int WATER = 223;
 
 out vec4 FragColor;
 in vec2 TexCoord;
+flat in vec2 AtlasOffset;
 in vec3 Normal;
 in float FogDepth;
 in float VoxelType;
 in float AO;
 
 uniform sampler2D texture1;
-uniform vec3 fogColor;
-uniform float fogDensity;
-uniform vec3 lightDir;
-uniform vec3 lightColor;
-uniform float ambientStrength;
+
+// Per-frame state shared by all programs; must match FrameUniforms in renderer.h.
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+    vec4 lightDir;
+    vec4 lightColor; // w: ambient strength
+    vec4 fogColor; // w: fog density
+    float time;
+};
 
 void main() {
-    vec4 texColor = texture(texture1, TexCoord);
+    // Wrap within the atlas tile; gradients come from the unwrapped coordinate
+    // so mip selection doesn't jump at tile seams.
+    float texSize = 1.0 / 16.0;
+    vec2 atlasCoord = AtlasOffset + fract(TexCoord) * texSize;
+    vec4 texColor = textureGrad(texture1, atlasCoord, dFdx(TexCoord) * texSize, dFdy(TexCoord) * texSize);
     if (texColor.a == 0.0)
         discard;
 
     vec3 norm = normalize(Normal);
 
-    vec3 lightDirection = normalize(lightDir);
+    vec3 lightDirection = normalize(lightDir.xyz);
     float diff = max(dot(norm, lightDirection), 0.0);
 
-    vec3 diffuse = diff * lightColor;
-    vec3 ambient = ambientStrength * lightColor * AO;
+    vec3 diffuse = diff * lightColor.rgb;
+    vec3 ambient = lightColor.w * lightColor.rgb * AO;
     vec3 lighting = ambient + diffuse;
 
     vec3 result = lighting * texColor.rgb;
 
-    float fogFactor = 1.0 - exp(-fogDensity * FogDepth);
+    float fogFactor = 1.0 - exp(-fogColor.w * FogDepth);
     fogFactor = clamp(fogFactor, 0.0, 1.0);
     fogFactor = 1.0 - fogFactor;
-    vec3 color = mix(fogColor, result, fogFactor);
+    vec3 color = mix(fogColor.rgb, result, fogFactor);
 
     FragColor = vec4(color, texColor.a);
 }
@@ -4,45 +4,118 @@ layout(location = 1) in vec2 aTexCoord;
 layout(location = 2) in vec3 aNormal;
 layout(location = 3) in float aVoxelType;
 layout(location = 4) in float aAO;
+layout(location = 5) in uvec2 aPacked;
 
 out vec2 TexCoord;
+flat out vec2 AtlasOffset;
 out vec3 Normal;
 out float FogDepth;
 out float VoxelType;
 out float AO;
 
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame state shared by all programs; must match FrameUniforms in renderer.h.
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos;
+    vec4 lightDir;
+    vec4 lightColor; // w: ambient strength
+    vec4 fogColor; // w: fog density
+    float time;
+};
+uniform int meshFormat; // CHUNK_MESH_FORMAT from global.h
+uniform vec3 chunkOrigin;
+uniform usamplerBuffer faceRecords;
+uniform int pageQuads; // Mega buffer page size in quads, 0 when chunks have their own buffers.
+uniform samplerBuffer pageOrigins;
+
+const int MESH_PACKED = 1;
+const int MESH_FACE_RECORDS = 2;
 
 const float WATER = 223.0;
 const float CACTUS = 70.0;
 const float WATER_Y_OFFSET = -0.2;
 const float CACTUS_INWARD_SLIDE = 0.1;
 
+// Same order as vertexNormals in chunk_mesher.cpp.
+const vec3 NORMALS[8] = vec3[8](
+    vec3(0.0, 0.0, 1.0), vec3(0.0, 0.0, -1.0), vec3(-1.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0),
+    vec3(0.0, 1.0, 0.0), vec3(0.0, -1.0, 0.0), vec3(1.0, 1.0, 1.0), vec3(-1.0, 1.0, 1.0)
+);
+
+// Same as faceCorners and faceTexCoords in chunk_mesher.cpp: four corners per
+// face, offsets from the block centre.
+const vec3 FACE_CORNERS[32] = vec3[32](
+    vec3(-0.5, -0.5,  0.5), vec3( 0.5, -0.5,  0.5), vec3( 0.5,  0.5,  0.5), vec3(-0.5,  0.5,  0.5),
+    vec3(-0.5, -0.5, -0.5), vec3( 0.5, -0.5, -0.5), vec3( 0.5,  0.5, -0.5), vec3(-0.5,  0.5, -0.5),
+    vec3(-0.5, -0.5, -0.5), vec3(-0.5, -0.5,  0.5), vec3(-0.5,  0.5,  0.5), vec3(-0.5,  0.5, -0.5),
+    vec3( 0.5, -0.5, -0.5), vec3( 0.5, -0.5,  0.5), vec3( 0.5,  0.5,  0.5), vec3( 0.5,  0.5, -0.5),
+    vec3(-0.5,  0.5, -0.5), vec3( 0.5,  0.5, -0.5), vec3( 0.5,  0.5,  0.5), vec3(-0.5,  0.5,  0.5),
+    vec3(-0.5, -0.5, -0.5), vec3( 0.5, -0.5, -0.5), vec3( 0.5, -0.5,  0.5), vec3(-0.5, -0.5,  0.5),
+    vec3(-0.5, -0.5, -0.5), vec3( 0.5, -0.5,  0.5), vec3( 0.5,  0.5,  0.5), vec3(-0.5,  0.5, -0.5),
+    vec3( 0.5, -0.5, -0.5), vec3(-0.5, -0.5,  0.5), vec3(-0.5,  0.5,  0.5), vec3( 0.5,  0.5, -0.5)
+);
+const vec2 CORNER_TEX_COORDS[4] = vec2[4](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+// Two triangles per face, matching the renderer's quad index buffer.
+const int QUAD_CORNERS[6] = int[6](0, 1, 2, 2, 3, 0);
+
 void main()
 {
     vec3 position = aPos;
+    vec2 texCoord = aTexCoord;
+    vec3 normal = aNormal;
+    float voxelType = aVoxelType;
+    float ao = aAO;
+
+    // In the mega buffer every page belongs to one chunk, and gl_VertexID
+    // includes the draw's first vertex, so it locates the page.
+    vec3 origin = chunkOrigin;
+    if (pageQuads > 0) {
+        int quad = gl_VertexID / (meshFormat == MESH_FACE_RECORDS ? 6 : 4);
+        vec2 pageOrigin = texelFetch(pageOrigins, quad / pageQuads).rg;
+        origin = vec3(pageOrigin.x, 0.0, pageOrigin.y);
+    }
+
+    // See ChunkMesher for the bit layouts.
+    if (meshFormat == MESH_FACE_RECORDS) {
+        uint record = texelFetch(faceRecords, gl_VertexID / 6).r;
+        int corner = QUAD_CORNERS[gl_VertexID % 6];
+        int face = int((record >> 16) & 7u);
+        vec3 block = vec3(record & 15u, (record >> 4) & 255u, (record >> 12) & 15u);
+        position = origin + block + FACE_CORNERS[face * 4 + corner];
+        normal = NORMALS[face];
+        texCoord = CORNER_TEX_COORDS[corner];
+        voxelType = float((record >> 19) & 255u);
+        ao = 1.0 - float((record >> 27) & 3u) / 3.0;
+    } else if (meshFormat == MESH_PACKED) {
+        uint word = aPacked.x;
+        position = vec3(word & 31u, (word >> 5) & 511u, (word >> 14) & 31u) - 0.5 + origin;
+        normal = NORMALS[(word >> 19) & 7u];
+        texCoord = vec2((word >> 22) & 31u, (word >> 27) & 31u);
+        voxelType = float(aPacked.y & 255u);
+        ao = float((aPacked.y >> 8) & 255u) / 255.0;
+    }
 
     // Add y offset for water voxels
-    if (aVoxelType == WATER) {
+    if (voxelType == WATER) {
         position.y += WATER_Y_OFFSET;
     }
 
     // Add inward slide for cactus faces
-    if (aVoxelType == CACTUS) {
-        position -= aNormal * CACTUS_INWARD_SLIDE;
+    if (voxelType == CACTUS) {
+        position -= normal * CACTUS_INWARD_SLIDE;
     }
 
     vec4 viewPos = view * vec4(position, 1.0);
     gl_Position = projection * viewPos;
 
     FogDepth = length(viewPos.xyz);
-    VoxelType = aVoxelType;
-    AO = aAO;
+    VoxelType = voxelType;
+    AO = ao;
 
     float texSize = 1.0 / 16.0;
-    vec2 baseCoord = vec2(mod(aVoxelType, 16.0), floor(aVoxelType / 16.0)) * texSize;
-    vec2 flippedTexCoord = vec2(aTexCoord.x, 1.0 - aTexCoord.y);
-    TexCoord = baseCoord + flippedTexCoord * texSize;
-    Normal = aNormal;
+    AtlasOffset = vec2(mod(voxelType, 16.0), floor(voxelType / 16.0)) * texSize;
+    // Left in tile units so greedy quads can repeat the tile in the fragment shader.
+    TexCoord = vec2(texCoord.x, 1.0 - texCoord.y);
+    Normal = normal;
 }
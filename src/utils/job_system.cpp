@@ -0,0 +1,117 @@
+#include "job_system.h"
+#include <algorithm>
+
+namespace {
+
+// Set on worker threads so submit() can push to the caller's own deque.
+thread_local const JobSystem* currentSystem = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+JobSystem::JobSystem(size_t workerCount)
+    : nextQueue(0), pendingJobs(0), stopping(false) {
+    if (workerCount == 0) {
+        workerCount = defaultWorkerCount();
+    }
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < workerCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+size_t JobSystem::defaultWorkerCount() {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads == 0) {
+        return 4; // Unknown; the old fixed worker count.
+    }
+    return std::max(1u, hardwareThreads - 1);
+}
+
+void JobSystem::submit(Job job) {
+    // Counted first, and under sleepMutex, so the count never drops below the
+    // queued jobs and a worker can't miss it between its last empty check and
+    // going to sleep.
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingJobs++;
+    }
+
+    size_t index = currentSystem == this ? currentWorker : nextQueue.fetch_add(1) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->jobs.push_back(std::move(job));
+    }
+    wakeCondition.notify_one();
+}
+
+size_t JobSystem::getWorkerCount() const {
+    return threads.size();
+}
+
+size_t JobSystem::getPendingJobs() const {
+    return pendingJobs.load();
+}
+
+bool JobSystem::popLocal(size_t index, Job& job) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    pendingJobs--;
+    return true;
+}
+
+// Takes from the back so the victim keeps working through its oldest jobs.
+bool JobSystem::steal(size_t thief, Job& job) {
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& queue = *queues[(thief + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            pendingJobs--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::workerLoop(size_t index) {
+    currentSystem = this;
+    currentWorker = index;
+
+    Job job;
+    while (true) {
+        if (popLocal(index, job) || steal(index, job)) {
+            job();
+            job = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeCondition.wait(lock, [this] { return stopping || pendingJobs > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
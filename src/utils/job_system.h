@@ -0,0 +1,56 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed pool of worker threads, each with its own job deque. Workers run their
+// own jobs oldest first and steal the newest job from another worker when
+// they run dry; with nothing left anywhere they sleep on a condition variable.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // workerCount 0 picks defaultWorkerCount().
+    explicit JobSystem(size_t workerCount = 0);
+    // Lets running jobs finish, drops queued ones and joins the workers.
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // From a worker the job goes to that worker's deque, otherwise the deques
+    // are filled round robin.
+    void submit(Job job);
+    size_t getWorkerCount() const;
+    size_t getPendingJobs() const;
+
+    // One worker per hardware thread, leaving one for the main thread.
+    static size_t defaultWorkerCount();
+
+private:
+    struct WorkerQueue {
+        std::deque<Job> jobs;
+        std::mutex mutex;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, Job& job);
+    bool steal(size_t thief, Job& job);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> nextQueue;
+    std::atomic<size_t> pendingJobs;
+    std::mutex sleepMutex;
+    std::condition_variable wakeCondition;
+    bool stopping; // Guarded by sleepMutex.
+};
+
+#endif // JOB_SYSTEM_H
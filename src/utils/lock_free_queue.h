@@ -0,0 +1,161 @@
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bounded ring buffers. tryPush fails when the queue is full and leaves the
+// value untouched; push waits for space instead, which is how producers get
+// back-pressure. Values are moved in and out, never copied. Capacities are
+// rounded up to a power of two.
+
+namespace lock_free_queue_detail {
+
+constexpr size_t CACHE_LINE = 64;
+
+inline size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// Spins briefly, then yields, then sleeps, so a producer blocked on a full
+// queue doesn't hold a core.
+inline void backoff(int& attempt) {
+    if (attempt < 16) {
+        // Busy retry.
+    } else if (attempt < 64) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    ++attempt;
+}
+
+} // namespace lock_free_queue_detail
+
+// Multi-producer, multi-consumer. Every cell carries a sequence number that
+// says whether it is ready to be written or read for a given ticket, so
+// producers and consumers only contend on their own position counter.
+template<typename T>
+class MpmcQueue {
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mask(lock_free_queue_detail::roundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+          cells(new Cell[mask + 1]), enqueuePos(0), dequeuePos(0) {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    bool tryPush(T&& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full.
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(T&& value) {
+        int attempt = 0;
+        while (!tryPush(std::move(value))) {
+            lock_free_queue_detail::backoff(attempt);
+        }
+    }
+
+    // Like push, but gives up once shouldAbort() returns true, e.g. when the
+    // consumer is shutting down. Returns whether the value was pushed.
+    template<typename Abort>
+    bool push(T&& value, Abort shouldAbort) {
+        int attempt = 0;
+        while (!tryPush(std::move(value))) {
+            if (shouldAbort()) {
+                return false;
+            }
+            lock_free_queue_detail::backoff(attempt);
+        }
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Empty.
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->value);
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Appends up to maxCount values to out; returns how many were taken.
+    size_t popBatch(std::vector<T>& out, size_t maxCount) {
+        size_t count = 0;
+        T value;
+        while (count < maxCount && tryPop(value)) {
+            out.push_back(std::move(value));
+            ++count;
+        }
+        return count;
+    }
+
+    // Exact only while no other thread is pushing or popping.
+    size_t sizeApprox() const {
+        size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(lock_free_queue_detail::CACHE_LINE) std::atomic<size_t> enqueuePos;
+    alignas(lock_free_queue_detail::CACHE_LINE) std::atomic<size_t> dequeuePos;
+};
+
+#endif // LOCK_FREE_QUEUE_H
@@ -0,0 +1,40 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stable LSD radix sort of items by a 32-bit key, one byte per pass. Passes
+// where every key has the same byte are skipped, so small keys cost fewer
+// passes. scratch is resized as needed; keep it around to avoid allocating.
+template<typename T, typename KeyFn>
+void radixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFn key) {
+    if (items.size() < 2) {
+        return;
+    }
+    scratch.resize(items.size());
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::array<size_t, 256> offsets{};
+        for (const T& item : items) {
+            offsets[(key(item) >> shift) & 0xFF]++;
+        }
+        if (offsets[(key(items[0]) >> shift) & 0xFF] == items.size()) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& count : offsets) {
+            size_t bucket = count;
+            count = offset;
+            offset += bucket;
+        }
+        for (const T& item : items) {
+            scratch[offsets[(key(item) >> shift) & 0xFF]++] = item;
+        }
+        items.swap(scratch);
+    }
+}
+
+#endif // RADIX_SORT_H
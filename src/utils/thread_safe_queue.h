@@ -1,45 +0,0 @@
-#ifndef THREAD_SAFE_QUEUE_H
-#define THREAD_SAFE_QUEUE_H
-
-#include <queue>
-#include <mutex>
-#include <condition_variable>
-
-template<typename T>
-class ThreadSafeQueue {
-public:
-    void push(const T& value) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(value);
-        condition_.notify_one();
-    }
-
-    bool tryPop(T& value) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (queue_.empty()) {
-            return false;
-        }
-        value = queue_.front();
-        queue_.pop();
-        return true;
-    }
-
-    void waitAndPop(T& value) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        condition_.wait(lock, [this] { return !queue_.empty(); });
-        value = queue_.front();
-        queue_.pop();
-    }
-
-    size_t size() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.size();
-    }
-
-private:
-    std::queue<T> queue_;
-    mutable std::mutex mutex_;
-    std::condition_variable condition_;
-};
-
-#endif // THREAD_SAFE_QUEUE_H
\ No newline at end of file
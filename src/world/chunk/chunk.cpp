@@ -1,199 +1,138 @@
 #include "chunk.h"
 #include "chunk_manager.h"
+#include "mesher/chunk_mesher.h"
+#include <algorithm>
 #include <iostream>
 #include <ostream>
 
 
 Chunk::Chunk(int width, int height, int depth, glm::vec2 index, ChunkManager* manager, unsigned int seed)
-    : width(width), height(height), depth(depth), index_(index), manager(manager),
-      terrainGenerator(width, height, depth, index, seed) {
+    : width(width), height(height), depth(depth), index_(index),
+      terrainGenerator(width, height, depth, index, seed), manager(manager) {
     std::srand(static_cast<unsigned>(std::time(0)));
-    terrainGenerator.generateTerrain(voxels, voxelsOutsideChunk);
-}
-
-Chunk::~Chunk() {
-    for (Voxel* voxel : voxels) {
-        delete voxel;
-    }
-}
-
-std::tuple<std::vector<float>, std::vector<unsigned int>, std::vector<float>, std::vector<unsigned int>> Chunk::getMesh() const {
-    std::vector<float> solidVertices;
-    std::vector<unsigned int> solidIndices;
-    std::vector<float> waterVertices;
-    std::vector<unsigned int> waterIndices;
-    glm::vec3 offset(index_.x * width, 0, index_.y * depth);
-    unsigned int solidBaseIndex = 0;
-    unsigned int waterBaseIndex = 0;
-
-    for (int x = 0; x < width; ++x) {
-        for (int y = 0; y < height; ++y) {
-            for (int z = 0; z < depth; ++z) {
-                glm::vec3 pos(x, y, z);
-                Voxel* voxel = getVoxel(pos);
-                if (voxel != nullptr) {
-                    uint8_t faceFlags = getFaceFlags(pos);
-                    if (voxel->isTranslucent()) {
-                        addVoxelMesh(voxel, offset, faceFlags, waterVertices, waterIndices, waterBaseIndex);
-                    } else {
-                        addVoxelMesh(voxel, offset, faceFlags, solidVertices, solidIndices, solidBaseIndex);
-                    }
-                }
+    std::vector<VoxelType> generated;
+    terrainGenerator.generateTerrain(generated, voxelsOutsideChunk);
+
+    // Split the generated column into sections; all-air sections keep no storage.
+    sections.resize(height / ChunkSection::SIZE);
+    // Both layouts are Y-major, so every section column is one contiguous copy.
+    std::array<VoxelType, ChunkSection::VOLUME> sectionBlocks;
+    for (int sectionY = 0; sectionY < static_cast<int>(sections.size()); ++sectionY) {
+        for (int x = 0; x < ChunkSection::SIZE; ++x) {
+            for (int z = 0; z < ChunkSection::SIZE; ++z) {
+                const VoxelType* column = &generated[terrainGenerator.coordsToIndex(x, sectionY * ChunkSection::SIZE, z)];
+                std::copy(column, column + ChunkSection::SIZE, &sectionBlocks[ChunkSection::coordsToIndex(x, 0, z)]);
             }
         }
+        sections[sectionY].load(sectionBlocks.data());
     }
-    return std::make_tuple(solidVertices, solidIndices, waterVertices, waterIndices);
 }
 
-void Chunk::addVoxelMesh(Voxel* voxel, const glm::vec3& offset, uint8_t faceFlags,
-                         std::vector<float>& vertices, std::vector<unsigned int>& indices,
-                         unsigned int& baseIndex) const {
-    // Get vertex data
-    std::vector<float> voxelVertices = voxel->getVertexData(offset, faceFlags, 1.0f);
-    vertices.insert(vertices.end(), voxelVertices.begin(), voxelVertices.end());
+void Chunk::getMesh(MeshData& mesh, MeshingMode mode) const {
+    // Four map lookups up front; the mesher then works lock-free on the snapshot.
+    std::array<std::shared_ptr<Chunk>, 4> neighbors = {
+        manager->getChunk(glm::ivec2(index_) + glm::ivec2(1, 0)),
+        manager->getChunk(glm::ivec2(index_) + glm::ivec2(-1, 0)),
+        manager->getChunk(glm::ivec2(index_) + glm::ivec2(0, 1)),
+        manager->getChunk(glm::ivec2(index_) + glm::ivec2(0, -1))
+    };
 
-    // Get index data
-    std::vector<unsigned int> voxelIndices = voxel->getIndexData(baseIndex, faceFlags);
-    indices.insert(indices.end(), voxelIndices.begin(), voxelIndices.end());
+    thread_local MeshVolume volume(width, height, depth);
+    volume.fill(*this, neighbors);
 
-    baseIndex += popcount(faceFlags) * 4; // 4 vertices per face.
+    glm::vec3 offset(index_.x * width, 0, index_.y * depth);
+    ChunkMesher(mode).buildMesh(volume, offset, mesh);
 }
 
-uint8_t Chunk::getFaceFlags(glm::vec3 pos) const {
-    uint8_t flags = 0;
-    Voxel* voxel = getVoxel(pos);
-
-    if (voxel->getIsXShaped()) {
-        return FACE_DIAGONAL_1 | FACE_DIAGONAL_2;
-    }
-
-    if (voxel->getType() == WATER) {
-        bool isTopWaterExposed = pos.y == height - 1 ||
-                                 !getVoxel({pos.x, pos.y + 1, pos.z}) ||
-                                 getVoxel({pos.x, pos.y + 1, pos.z})->getType() != WATER;
-        return isTopWaterExposed ? FACE_TOP : 0;
+uint32_t Chunk::copyColumns(const glm::ivec2& min, const glm::ivec2& max, MeshVolume& volume, const glm::ivec2& volumeOffset) const {
+    std::shared_lock<std::shared_mutex> lock(voxelsMutex);
+    for (int x = min.x; x < max.x; ++x) {
+        for (int z = min.y; z < max.y; ++z) {
+            VoxelType* column = volume.getColumn(x + volumeOffset.x, z + volumeOffset.y);
+            for (size_t sectionY = 0; sectionY < sections.size(); ++sectionY) {
+                sections[sectionY].readColumn(x, z, column + sectionY * ChunkSection::SIZE);
+            }
+        }
     }
 
-    flags |= checkFace(pos, {0, 0, 1}, FACE_FRONT);
-    flags |= checkFace(pos, {0, 0, -1}, FACE_BACK);
-    flags |= checkFace(pos, {-1, 0, 0}, FACE_LEFT);
-    flags |= checkFace(pos, {1, 0, 0}, FACE_RIGHT);
-    flags |= checkFace(pos, {0, 1, 0}, FACE_TOP);
-    flags |= checkFace(pos, {0, -1, 0}, FACE_BOTTOM);
-
-    return flags;
-}
-
-uint8_t Chunk::checkFace(glm::vec3 pos, glm::vec3 offset, uint8_t faceFlag) const {
-    glm::vec3 neighborPos = pos + offset;
-
-    if (isOutOfBounds(neighborPos)) {
-        std::shared_ptr<Chunk> neighborChunk = getNeighborChunk(neighborPos);
-        if (!neighborChunk) return faceFlag;
-
-        glm::vec3 wrappedPos = wrapPosition(neighborPos);
-        return shouldRenderFace(neighborChunk->getVoxel(wrappedPos)) ? faceFlag : 0;
+    uint32_t nonEmptySections = 0;
+    for (size_t sectionY = 0; sectionY < sections.size(); ++sectionY) {
+        if (!sections[sectionY].isEmpty()) {
+            nonEmptySections |= 1u << sectionY;
+        }
     }
-
-    return shouldRenderFace(getVoxel(neighborPos)) ? faceFlag : 0;
+    return nonEmptySections;
 }
 
-bool Chunk::isOutOfBounds(glm::vec3 pos) const {
+bool Chunk::isOutOfBounds(const glm::ivec3& pos) const {
     return pos.x < 0 || pos.x >= width ||
            pos.y < 0 || pos.y >= height ||
            pos.z < 0 || pos.z >= depth;
 }
 
-std::shared_ptr<Chunk> Chunk::getNeighborChunk(glm::vec3 pos) const {
-    glm::vec2 offset(0);
-    if (pos.x < 0) offset.x = -1;
-    else if (pos.x >= width) offset.x = 1;
-    else if (pos.z < 0) offset.y = -1;
-    else if (pos.z >= depth) offset.y = 1;
-
-    return manager->getChunk(index_ + offset);
+glm::ivec3 Chunk::wrapPosition(const glm::ivec3& pos) const {
+    return glm::ivec3((pos.x + width) % width, pos.y, (pos.z + depth) % depth);
 }
 
-glm::vec3 Chunk::wrapPosition(glm::vec3 pos) const {
-    return glm::vec3(
-        static_cast<float>(static_cast<int>(pos.x + width) % width),
-        pos.y,
-        static_cast<float>(static_cast<int>(pos.z + depth) % depth)
-    );
+VoxelType Chunk::getVoxel(const glm::ivec3& pos) const {
+    std::shared_lock<std::shared_mutex> lock(voxelsMutex);
+    return voxelAt(pos);
 }
 
-void Chunk::updateMesh() {
-
-    bool allNeighborsReady = true;
-    for (const auto& offset : {glm::vec2(1, 0), glm::vec2(-1, 0), glm::vec2(0, 1), glm::vec2(0, -1)}) {
-        if (!manager->getChunk(index_ + offset)) {
-            allNeighborsReady = false;
-            break;
-        }
-    }
-
-    if (allNeighborsReady) {
-        cachedMesh = getMesh();
+// Caller must hold voxelsMutex.
+VoxelType Chunk::voxelAt(const glm::ivec3& pos) const {
+    if (isOutOfBounds(pos)) {
+        return AIR;
     }
+    return sections[pos.y / ChunkSection::SIZE].get(pos.x, pos.y % ChunkSection::SIZE, pos.z);
 }
 
 
-bool Chunk::shouldRenderFace(const Voxel* voxel) const {
-    return !voxel || voxel->getType() == WATER ||
-                     voxel->getType() == LEAVES ||
-                     voxel->getType() == CACTUS ||   // Improve this chechup.
-                     voxel->getType() == FLOWER ||
-                     voxel->getIsXShaped();
-    // Transparent voxels should not cause faces to be hidden.
-    // Optimise leaves to occlude each other later.
-}
-
-Voxel* Chunk::getVoxel(const glm::vec3& pos) const {
-    unsigned int index = coordsToIndex(pos);
-    if (index < voxels.size()) {
-        return voxels[index];
+// Returns whether the block actually changed.
+bool Chunk::setVoxel(const glm::ivec3& pos, VoxelType type) {
+    if (isOutOfBounds(pos)) {
+        return false;
     }
-    return nullptr;
-}
-
-
-void Chunk::setVoxel(const glm::vec3& pos, VoxelType type) {
-    unsigned int index = coordsToIndex(pos);
-    if (index < voxels.size()) {
-        delete voxels[index];
-        voxels[index] = new Voxel(pos, type);
+    std::unique_lock<std::shared_mutex> lock(voxelsMutex);
+    ChunkSection& section = sections[pos.y / ChunkSection::SIZE];
+    if (section.get(pos.x, pos.y % ChunkSection::SIZE, pos.z) == type) {
+        return false;
     }
-}
-
-unsigned int Chunk::coordsToIndex(glm::vec3 coords) const {
-    return static_cast<unsigned int>(
-        coords.x +
-        coords.y * width +
-        coords.z * width * height
-    );
-}
-
-glm::vec3 Chunk::indexToCoords(int index) const {
-    return glm::vec3(
-        index % width,
-        (index / width) % height,
-        index / (width * height)
-    );
+    section.set(pos.x, pos.y % ChunkSection::SIZE, pos.z, type);
+    return true;
 }
 
 glm::vec2 Chunk::getIndex() const {
     return index_;
 }
 
+size_t Chunk::getMemoryUsage() const {
+    std::shared_lock<std::shared_mutex> lock(voxelsMutex);
+    size_t total = sizeof(Chunk) + voxelsOutsideChunk.capacity() * sizeof(Voxel);
+    for (const ChunkSection& section : sections) {
+        total += section.getMemoryUsage();
+    }
+    return total;
+}
+
 bool Chunk::operator==(const Chunk& other) const {
     return index_ == other.index_;
 }
 
 
-void Chunk::placeOutsideVoxels() {
-    for (Voxel* voxel : voxelsOutsideChunk) {
+// Returns the chunks whose meshes the placed blocks changed: the chunk written
+// to, plus the chunk across any border the block sits on.
+std::vector<glm::ivec2> Chunk::placeOutsideVoxels() {
+    std::vector<glm::ivec2> changedChunks;
+    auto markChanged = [&changedChunks](const glm::ivec2& chunkPos) {
+        if (std::find(changedChunks.begin(), changedChunks.end(), chunkPos) == changedChunks.end()) {
+            changedChunks.push_back(chunkPos);
+        }
+    };
+
+    for (const Voxel& voxel : voxelsOutsideChunk) {
         glm::vec2 chunkOffset(0);
-        glm::vec3 localPos = voxel->getPosition();
+        glm::ivec3 localPos(voxel.getPosition());
 
         if (localPos.x < 0) chunkOffset.x = -1;
         else if (localPos.x >= width) chunkOffset.x = 1;
@@ -202,13 +141,16 @@ void Chunk::placeOutsideVoxels() {
 
         std::shared_ptr<Chunk> neighborChunk = manager->getChunk(index_ + chunkOffset);
 
-        if (neighborChunk) {
-            glm::vec3 adjustedPos = localPos;
-            adjustedPos.x = (static_cast<int>(adjustedPos.x) + width) %  width;
-            adjustedPos.z = (static_cast<int>(adjustedPos.z) + depth) % depth;
-
-            neighborChunk->setVoxel(adjustedPos, voxel->getType());
+        glm::ivec3 wrapped = wrapPosition(localPos);
+        if (neighborChunk && neighborChunk->setVoxel(wrapped, voxel.getType())) {
+            glm::ivec2 neighborIndex = glm::ivec2(index_ + chunkOffset);
+            markChanged(neighborIndex);
+            if (wrapped.x == 0) markChanged(neighborIndex + glm::ivec2(-1, 0));
+            else if (wrapped.x == width - 1) markChanged(neighborIndex + glm::ivec2(1, 0));
+            if (wrapped.z == 0) markChanged(neighborIndex + glm::ivec2(0, -1));
+            else if (wrapped.z == depth - 1) markChanged(neighborIndex + glm::ivec2(0, 1));
         }
     }
     voxelsOutsideChunk.clear();
+    return changedChunks;
 }
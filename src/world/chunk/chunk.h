@@ -2,14 +2,18 @@
 #define CHUNK_H
 
 #include <vector>
-#include <tuple>
+#include <array>
 #include <memory>
+#include <shared_mutex>
 #include <glm/glm.hpp>
 #include "../voxel/voxel.h"
 #include "../voxel/types.h"
 #include "../../utils/perlin.h"
 #include "../../utils/pop_count.h"
 #include "terrain_generator/terrain_generator.h"
+#include "chunk_section.h"
+#include "mesher/mesh_volume.h"
+#include "mesher/chunk_mesher.h"
 class ChunkManager;
 #include "chunk_manager.h"
 
@@ -17,40 +21,29 @@ class ChunkManager;
 class Chunk {
 public:
     Chunk(int width, int height, int depth, glm::vec2 index, ChunkManager* manager, unsigned int seed);
-    ~Chunk();
 
-    std::tuple<std::vector<float>, std::vector<unsigned int>,
-               std::vector<float>, std::vector<unsigned int>> getMesh() const;
-    Voxel* getVoxel(const glm::vec3& pos) const;
-    void setVoxel(const glm::vec3& pos, VoxelType type);
+    void getMesh(MeshData& mesh, MeshingMode mode = MeshingMode::PER_FACE) const;
+    VoxelType getVoxel(const glm::ivec3& pos) const;
+    uint32_t copyColumns(const glm::ivec2& min, const glm::ivec2& max, MeshVolume& volume, const glm::ivec2& volumeOffset) const;
+    bool setVoxel(const glm::ivec3& pos, VoxelType type);
     glm::vec2 getIndex() const;
+    size_t getMemoryUsage() const;
     bool operator==(const Chunk& other) const;
-    void placeOutsideVoxels();
-    void updateMesh();
+    std::vector<glm::ivec2> placeOutsideVoxels();
 
 private:
-    void addVoxelMesh(Voxel* voxel, const glm::vec3& offset, uint8_t faceFlsags,
-                      std::vector<float>& vertices, std::vector<unsigned int>& indices,
-                      unsigned int& baseIndex) const;
-    glm::vec3 indexToCoords(int index) const;
-    unsigned int coordsToIndex(glm::vec3 coords) const;
-    uint8_t getFaceFlags(glm::vec3 pos) const;
-
-    uint8_t checkFace(glm::vec3 pos, glm::vec3 offset, uint8_t faceFlag) const;
-    bool isOutOfBounds(glm::vec3 pos) const;
-    std::shared_ptr<Chunk> getNeighborChunk(glm::vec3 pos) const;
-    glm::vec3 wrapPosition(glm::vec3 pos) const;
-    bool shouldRenderFace(const Voxel* voxel) const;
+    VoxelType voxelAt(const glm::ivec3& pos) const;
+    bool isOutOfBounds(const glm::ivec3& pos) const;
+    glm::ivec3 wrapPosition(const glm::ivec3& pos) const;
 
     int width, height, depth;
     glm::vec2 index_;
-    std::vector<Voxel*> voxels;
+    std::vector<ChunkSection> sections; // Bottom to top, ChunkSection::SIZE blocks tall each.
+    mutable std::shared_mutex voxelsMutex; // setVoxel may repack a section while other threads read.
     TerrainGenerator terrainGenerator;
     ChunkManager* manager;
-    std::tuple<std::vector<float>, std::vector<unsigned int>,
-               std::vector<float>, std::vector<unsigned int>> cachedMesh;
 
-    std::vector<Voxel*> voxelsOutsideChunk; // Store voxels generated outside the chunk, and pass to neighbouring chunk.
+    std::vector<Voxel> voxelsOutsideChunk; // Store voxels generated outside the chunk, and pass to neighbouring chunk.
 
 
 };
@@ -3,26 +3,35 @@
 #include <iostream>
 #include <shared_mutex>
 #include <cmath>
-#include <queue>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// The eight chunks around a chunk; decoration can write into any of them.
+const glm::ivec2 NEIGHBORHOOD[] = {
+    {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}
+};
+const int NEIGHBORHOOD_SIZE = 8;
+
+} // namespace
 
 ChunkManager::ChunkManager(int chunkWidth, int chunkHeight, int chunkDepth, int viewDistance)
     : chunkWidth(chunkWidth), chunkHeight(chunkHeight), chunkDepth(chunkDepth), viewDistance(viewDistance),
-      running(false), lastLoadedCenterChunk(2, 2) {
+      renderQueue(RENDER_QUEUE_CAPACITY), meshPool(MESH_POOL_SIZE), lastLoadedCenterChunk(2, 2), shuttingDown(false), meshingMode(MeshingMode::PER_FACE) {
 }
 
-void ChunkManager::init(unsigned int s){
+void ChunkManager::init(unsigned int s, size_t workerCount){
     seed = s;
-    startWorkers(4);
-    running = true;
+    jobs = std::make_unique<JobSystem>(workerCount);
+    std::cout << "Chunk workers: " << jobs->getWorkerCount() << std::endl;
 }
 
 ChunkManager::~ChunkManager() {
-    running = false;
-    for (auto& worker : workers) {
-        if (worker.joinable()) {
-            worker.join();
-        }
-    }
+    // Nothing drains renderQueue any more; release workers waiting on it.
+    shuttingDown = true;
+    // Joins the workers while the members their jobs use are still alive.
+    jobs.reset();
 }
 
 glm::ivec2 ChunkManager::worldToChunkCoords(const glm::vec3& worldPos) {
@@ -40,15 +49,36 @@ void ChunkManager::loadChunks() {
 void ChunkManager::unloadChunks() {
     glm::ivec2 playerChunk = worldToChunkCoords(playerPosition);
     std::lock_guard<std::mutex> lock(chunksMutex);
-    for (auto it = chunks.begin(); it != chunks.end();) {
+    for (auto it = chunkRecords.begin(); it != chunkRecords.end();) {
         glm::ivec2 chunkPos = it->first;
-        if (!isChunkInLoadDistance(chunkPos, playerChunk)) {
-            renderQueue.push({chunkPos, {}, {}, {}, {}});
-            chunkStates.erase(chunkPos);
-            it = chunks.erase(it);
-        } else {
+        if (isChunkInLoadDistance(chunkPos, playerChunk)) {
             ++it;
+            continue;
+        }
+
+        // Take this chunk out of its neighbours' counts. Tasks still in flight
+        // find the record gone and drop their results.
+        ChunkGenerationState state = it->second.state;
+        for (const glm::ivec2& offset : NEIGHBORHOOD) {
+            auto neighbor = chunkRecords.find(chunkPos + offset);
+            if (neighbor == chunkRecords.end()) {
+                continue;
+            }
+            ChunkRecord& record = neighbor->second;
+            if (state >= ChunkGenerationState::GENERATED && record.state >= ChunkGenerationState::GENERATED) {
+                record.generatedNeighbors--;
+            }
+            if (state >= ChunkGenerationState::DECORATED && record.state >= ChunkGenerationState::DECORATED) {
+                record.decoratedNeighbors--;
+            }
+        }
+
+        // Not through renderQueue: this thread drains it, so it must never
+        // wait on it being full.
+        if (chunks.erase(chunkPos) > 0) {
+            unloadedChunks.push_back(chunkPos);
         }
+        it = chunkRecords.erase(it);
     }
 }
 
@@ -62,23 +92,6 @@ void ChunkManager::updatePlayerPosition(const glm::vec3& position) {
     unloadChunks();
 }
 
-void ChunkManager::startWorkers(size_t numWorkers) {
-    for (size_t i = 0; i < numWorkers; ++i) {
-        workers.emplace_back(&ChunkManager::workerFunction, this);
-    }
-}
-
-void ChunkManager::workerFunction() {
-    while (running) {
-        std::function<void()> task;
-        if (taskQueue.tryPop(task)) {
-            task();
-        } else {
-            std::this_thread::yield();
-        }
-    }
-}
-
 std::shared_ptr<Chunk> ChunkManager::getChunk(const glm::ivec2& chunkPos) {
     std::lock_guard<std::mutex> lock(chunksMutex);
     auto it = chunks.find(chunkPos);
@@ -88,12 +101,30 @@ std::shared_ptr<Chunk> ChunkManager::getChunk(const glm::ivec2& chunkPos) {
     return nullptr;
 }
 
-ThreadSafeQueue<std::tuple<glm::ivec2, std::vector<float>, std::vector<unsigned int>, std::vector<float>, std::vector<unsigned int>>>& ChunkManager::getRenderQueue() {
+MpmcQueue<ChunkMeshUpdate>& ChunkManager::getRenderQueue() {
     return renderQueue;
 }
 
+std::vector<glm::ivec2> ChunkManager::takeUnloadedChunks() {
+    std::lock_guard<std::mutex> lock(chunksMutex);
+    std::vector<glm::ivec2> unloaded;
+    std::swap(unloaded, unloadedChunks);
+    return unloaded;
+}
+
+// Meshes can still arrive for a chunk after it was unloaded; unloading only
+// happens on the main thread, so checking here when draining is exact.
+bool ChunkManager::isChunkLoaded(const glm::ivec2& chunkPos) {
+    std::lock_guard<std::mutex> lock(chunksMutex);
+    return chunkRecords.find(chunkPos) != chunkRecords.end();
+}
+
+void ChunkManager::recycleMesh(MeshData&& mesh) {
+    meshPool.release(std::move(mesh));
+}
+
 void ChunkManager::expandLoadedArea(const glm::ivec2& newCenterChunk) {
-    std::priority_queue<ChunkTask> chunkTaskQueue;
+    std::vector<ChunkTask> chunkTasks;
 
     int start_x = newCenterChunk.x - viewDistance;
     int end_x = newCenterChunk.x + viewDistance;
@@ -104,30 +135,101 @@ void ChunkManager::expandLoadedArea(const glm::ivec2& newCenterChunk) {
         for (int z = start_z; z <= end_z; ++z) {
             glm::ivec2 chunkPos(x, z);
             float distance = glm::length(glm::vec2(chunkPos - newCenterChunk));
-            chunkTaskQueue.push({chunkPos, distance});
+            chunkTasks.push_back({chunkPos, distance});
         }
     }
 
-    while (!chunkTaskQueue.empty()) {
-        ChunkTask task = chunkTaskQueue.top();
-        chunkTaskQueue.pop();
+    std::sort(chunkTasks.begin(), chunkTasks.end());
 
+    for (const auto& task : chunkTasks) {
         std::lock_guard<std::mutex> lock(chunksMutex);
-        if (chunks.find(task.chunkPos) == chunks.end()) {
-            chunkStates[task.chunkPos] = ChunkGenerationState::QUEUED;
-            taskQueue.push([this, task] {
-                chunkStates[task.chunkPos] = ChunkGenerationState::GENERATING;
-                auto chunk = std::make_shared<Chunk>(chunkWidth, chunkHeight, chunkDepth, task.chunkPos, this, seed);
+        if (chunkRecords.find(task.chunkPos) == chunkRecords.end()) {
+            chunkRecords[task.chunkPos] = ChunkRecord();
+            jobs->submit([this, chunkPos = task.chunkPos] {
                 {
+                    // Skip if the chunk was unloaded, or reloaded and already picked up.
                     std::lock_guard<std::mutex> lock(chunksMutex);
-                    chunks[task.chunkPos] = chunk;
-                    chunkStates[task.chunkPos] = ChunkGenerationState::GENERATED;
+                    auto it = chunkRecords.find(chunkPos);
+                    if (it == chunkRecords.end() || it->second.state != ChunkGenerationState::QUEUED) {
+                        return;
+                    }
+                    it->second.state = ChunkGenerationState::GENERATING;
                 }
+
+                auto chunk = std::make_shared<Chunk>(chunkWidth, chunkHeight, chunkDepth, chunkPos, this, seed);
+
+                std::lock_guard<std::mutex> lock(chunksMutex);
+                auto it = chunkRecords.find(chunkPos);
+                if (it == chunkRecords.end()) {
+                    return;
+                }
+                chunks[chunkPos] = chunk;
+                it->second.state = ChunkGenerationState::GENERATED;
+                onChunkGenerated(chunkPos, it->second);
+
+                std::lock_guard<std::mutex> statsLock(statsMutex);
+                meshingStats.chunksLoaded++;
             });
         }
     }
 }
 
+// The on* helpers and requestRemesh expect chunksMutex to be held.
+void ChunkManager::onChunkGenerated(const glm::ivec2& chunkPos, ChunkRecord& record) {
+    for (const glm::ivec2& offset : NEIGHBORHOOD) {
+        auto neighbor = chunkRecords.find(chunkPos + offset);
+        if (neighbor != chunkRecords.end() && neighbor->second.state >= ChunkGenerationState::GENERATED) {
+            record.generatedNeighbors++;
+            neighbor->second.generatedNeighbors++;
+            queueIfReady(neighbor->first, neighbor->second);
+        }
+    }
+    queueIfReady(chunkPos, record);
+}
+
+void ChunkManager::onChunkDecorated(const glm::ivec2& chunkPos, ChunkRecord& record) {
+    for (const glm::ivec2& offset : NEIGHBORHOOD) {
+        auto neighbor = chunkRecords.find(chunkPos + offset);
+        if (neighbor != chunkRecords.end() && neighbor->second.state >= ChunkGenerationState::DECORATED) {
+            record.decoratedNeighbors++;
+            neighbor->second.decoratedNeighbors++;
+            queueIfReady(neighbor->first, neighbor->second);
+        }
+    }
+    queueIfReady(chunkPos, record);
+}
+
+// False once the chunk has been unloaded, even if it was loaded again since.
+bool ChunkManager::isCurrentChunk(const glm::ivec2& chunkPos, const std::shared_ptr<Chunk>& chunk) const {
+    auto it = chunks.find(chunkPos);
+    return it != chunks.end() && it->second == chunk;
+}
+
+bool ChunkManager::isReady(const ChunkRecord& record) const {
+    return (record.state == ChunkGenerationState::GENERATED && record.generatedNeighbors == NEIGHBORHOOD_SIZE) ||
+           (record.state == ChunkGenerationState::DECORATED && record.decoratedNeighbors == NEIGHBORHOOD_SIZE);
+}
+
+void ChunkManager::queueIfReady(const glm::ivec2& chunkPos, const ChunkRecord& record) {
+    if (isReady(record)) {
+        readyChunks.push_back(chunkPos);
+    }
+}
+
+// Meshed chunks go back to DECORATED; chunks mid-mesh run again when done.
+void ChunkManager::requestRemesh(const glm::ivec2& chunkPos) {
+    auto it = chunkRecords.find(chunkPos);
+    if (it == chunkRecords.end()) {
+        return;
+    }
+    if (it->second.state == ChunkGenerationState::MESHED) {
+        it->second.state = ChunkGenerationState::DECORATED;
+        queueIfReady(chunkPos, it->second);
+    } else if (it->second.state == ChunkGenerationState::MESHING) {
+        it->second.remeshPending = true;
+    }
+}
+
 bool ChunkManager::isChunkInLoadDistance(const glm::ivec2& chunkPos, const glm::ivec2& centerChunk) {
     glm::ivec2 diff = glm::abs(chunkPos - centerChunk);
     return diff.x <= viewDistance && diff.y <= viewDistance;
@@ -137,58 +239,149 @@ int ChunkManager::getLoadedChunksCount() const {
     return chunks.size();
 }
 
+size_t ChunkManager::getMemoryUsage() {
+    std::lock_guard<std::mutex> lock(chunksMutex);
+    size_t total = 0;
+    for (const auto& [chunkPos, chunk] : chunks) {
+        total += chunk->getMemoryUsage();
+    }
+    return total;
+}
+
 void ChunkManager::updateChunks() {
     std::vector<ChunkTask> chunksToUpdate;
     glm::ivec2 playerChunk = worldToChunkCoords(playerPosition);
 
     {
         std::lock_guard<std::mutex> lock(chunksMutex);
-        for (auto& [chunkPos, chunk] : chunks) {
-            if (chunkStates[chunkPos] == ChunkGenerationState::GENERATED) {
-                float distance = glm::length(glm::vec2(chunkPos - playerChunk));
-                chunksToUpdate.push_back({chunkPos, distance}); // Closer chunks have smaller distance
-            }
+        for (const glm::ivec2& chunkPos : readyChunks) {
+            float distance = glm::length(glm::vec2(chunkPos - playerChunk));
+            chunksToUpdate.push_back({chunkPos, distance}); // Closer chunks have smaller distance
         }
+        readyChunks.clear();
     }
 
     std::sort(chunksToUpdate.begin(), chunksToUpdate.end());
 
     for (const auto& task : chunksToUpdate) {
         std::lock_guard<std::mutex> lock(chunksMutex);
+        // Entries can be stale or repeated; the record decides.
+        auto it = chunkRecords.find(task.chunkPos);
+        if (it == chunkRecords.end() || !isReady(it->second)) {
+            continue;
+        }
         auto chunk = chunks[task.chunkPos];
-        bool allNeighborsGenerated = true;
 
-        for (const auto& offset : {glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1)}) {
-            glm::ivec2 neighborPos = task.chunkPos + offset;
-            if (chunks.find(neighborPos) == chunks.end() || chunkStates[neighborPos] == ChunkGenerationState::QUEUED) {
-                allNeighborsGenerated = false;
-                break;
-            }
-        }
+        if (it->second.state == ChunkGenerationState::GENERATED) {
+            it->second.state = ChunkGenerationState::DECORATING;
+            jobs->submit([this, chunkPos = task.chunkPos, chunk] {
+                std::vector<glm::ivec2> changedChunks = chunk->placeOutsideVoxels();
+
+                std::lock_guard<std::mutex> lock(chunksMutex);
+                auto it = chunkRecords.find(chunkPos);
+                if (it == chunkRecords.end() || !isCurrentChunk(chunkPos, chunk)) {
+                    return;
+                }
+                it->second.state = ChunkGenerationState::DECORATED;
+                onChunkDecorated(chunkPos, it->second);
+
+                // Only matters for chunks that are already meshed, e.g. next to
+                // a neighbour that was unloaded and generated again.
+                for (const glm::ivec2& changedPos : changedChunks) {
+                    requestRemesh(changedPos);
+                }
+            });
+        } else {
+            it->second.state = ChunkGenerationState::MESHING;
+            jobs->submit([this, chunkPos = task.chunkPos, chunk] {
+                MeshData mesh = meshChunk(chunk);
 
-        if (allNeighborsGenerated) {
-            chunkStates[task.chunkPos] = ChunkGenerationState::MESHING;
-            taskQueue.push([this, chunkPos = task.chunkPos, chunk] {
-                // Place outside voxels
-                chunk->placeOutsideVoxels();
-
-                // Generate mesh for this chunk
-                auto [solidVertices, solidIndices, waterVertices, waterIndices] = chunk->getMesh();
-                renderQueue.push({chunkPos, std::move(solidVertices), std::move(solidIndices), std::move(waterVertices), std::move(waterIndices)});
-
-                // Update neighboring chunk meshes
-                for (const auto& offset : {glm::ivec2(1, 0), glm::ivec2(-1, 0), glm::ivec2(0, 1), glm::ivec2(0, -1)}) {
-                    glm::ivec2 neighborPos = chunkPos + offset;
-                    auto neighborChunk = getChunk(neighborPos);
-                    if (neighborChunk) {
-                        auto [nSolidVertices, nSolidIndices, nWaterVertices, nWaterIndices] = neighborChunk->getMesh();
-                        renderQueue.push({neighborPos, std::move(nSolidVertices), std::move(nSolidIndices), std::move(nWaterVertices), std::move(nWaterIndices)});
+                {
+                    std::lock_guard<std::mutex> lock(chunksMutex);
+                    auto it = chunkRecords.find(chunkPos);
+                    if (it == chunkRecords.end() || !isCurrentChunk(chunkPos, chunk)) {
+                        meshPool.release(std::move(mesh));
+                        return;
                     }
                 }
 
+                // Waits while the main thread is behind, holding no locks. The
+                // chunk stays MESHING meanwhile, so a newer mesh of it can't
+                // overtake this one.
+                if (!renderQueue.push({chunkPos, std::move(mesh)}, [this] { return shuttingDown.load(); })) {
+                    return;
+                }
+
                 std::lock_guard<std::mutex> lock(chunksMutex);
-                chunkStates[chunkPos] = ChunkGenerationState::MESHED;
+                auto it = chunkRecords.find(chunkPos);
+                if (it == chunkRecords.end() || !isCurrentChunk(chunkPos, chunk)) {
+                    return;
+                }
+
+                ChunkRecord& record = it->second;
+                if (record.meshed) {
+                    std::lock_guard<std::mutex> statsLock(statsMutex);
+                    meshingStats.remeshes++;
+                }
+                record.meshed = true;
+
+                if (record.remeshPending) {
+                    record.remeshPending = false;
+                    record.state = ChunkGenerationState::DECORATED;
+                    queueIfReady(chunkPos, record);
+                } else {
+                    record.state = ChunkGenerationState::MESHED;
+                }
             });
         }
     }
 }
+
+MeshData ChunkManager::meshChunk(const std::shared_ptr<Chunk>& chunk) {
+    MeshData mesh;
+    bool pooled = meshPool.acquire(mesh);
+    size_t solidCapacity = mesh.solidVertices.capacity();
+    size_t waterCapacity = mesh.waterVertices.capacity();
+    auto start = std::chrono::steady_clock::now();
+    chunk->getMesh(mesh, meshingMode);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    size_t wordCount = mesh.solidVertices.size() + mesh.waterVertices.size();
+    bool grew = mesh.solidVertices.capacity() != solidCapacity || mesh.waterVertices.capacity() != waterCapacity;
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    meshingStats.meshes++;
+    meshingStats.totalMeshes++;
+    meshingStats.quads += wordCount / CHUNK_QUAD_WORDS;
+    meshingStats.bytes += wordCount * sizeof(uint32_t);
+    meshingStats.microseconds += elapsed.count();
+    meshingStats.poolMisses += !pooled;
+    meshingStats.bufferGrowths += pooled && grew;
+    return mesh;
+}
+
+void ChunkManager::setMeshingMode(MeshingMode mode) {
+    if (meshingMode.exchange(mode) == mode) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        MeshingStats lifetime = meshingStats;
+        meshingStats = MeshingStats();
+        meshingStats.chunksLoaded = lifetime.chunksLoaded;
+        meshingStats.totalMeshes = lifetime.totalMeshes;
+        meshingStats.remeshes = lifetime.remeshes;
+    }
+
+    // Send meshed chunks back through updateChunks so they pick up the new mode.
+    std::lock_guard<std::mutex> lock(chunksMutex);
+    for (auto& [chunkPos, record] : chunkRecords) {
+        requestRemesh(chunkPos);
+    }
+}
+
+MeshingStats ChunkManager::getMeshingStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return meshingStats;
+}
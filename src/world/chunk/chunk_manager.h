@@ -13,64 +13,103 @@
 class Chunk;
 #include "chunk.h"
 #include "../../utils/hash.h"
-#include "../../utils/thread_safe_queue.h"
+#include "../../utils/lock_free_queue.h"
+#include "../../utils/job_system.h"
 
 
+// Stages run in order. Decoration places the blocks a chunk generated past its
+// edges (tree parts) into its neighbours, so it waits for all eight neighbours
+// to be generated; meshing waits for all eight to be decorated.
 enum class ChunkGenerationState {
     QUEUED,
     GENERATING,
     GENERATED,
+    DECORATING,
+    DECORATED,
     MESHING,
     MESHED
 };
 
-struct ChunkTask {
+// A finished chunk mesh on its way to the renderer.
+struct ChunkMeshUpdate {
     glm::ivec2 chunkPos;
-    float priority;
-    bool operator<(const ChunkTask& other) const {
-        return priority < other.priority;
-    }
+    MeshData mesh;
 };
 
+// Meshes waiting for the main thread. Workers block once it is full.
+const size_t RENDER_QUEUE_CAPACITY = 256;
+// Uploaded meshes kept for reuse.
+const size_t MESH_POOL_SIZE = 64;
+
 
 class ChunkManager {
 public:
     ChunkManager(int chunkWidth, int chunkHeight, int chunkDepth, int viewDistance);
     ~ChunkManager();
-    void init(unsigned int seed);
+    // workerCount 0 sizes the job system from the hardware thread count.
+    void init(unsigned int seed, size_t workerCount = 0);
     void updatePlayerPosition(const glm::vec3& playerPos);
     std::shared_ptr<Chunk> getChunk(const glm::ivec2& chunkPos);
-    ThreadSafeQueue<std::tuple<glm::ivec2, std::vector<float>, std::vector<unsigned int>, std::vector<float>, std::vector<unsigned int>>>& getRenderQueue();
+    MpmcQueue<ChunkMeshUpdate>& getRenderQueue();
+    // Chunks unloaded since the last call; main thread only.
+    std::vector<glm::ivec2> takeUnloadedChunks();
+    bool isChunkLoaded(const glm::ivec2& chunkPos);
+    // Hands an uploaded mesh's buffers back for the next meshing job.
+    void recycleMesh(MeshData&& mesh);
     int getLoadedChunksCount() const;
+    size_t getMemoryUsage();
+    void setMeshingMode(MeshingMode mode);
+    MeshingStats getMeshingStats();
     void updateChunks();
     glm::ivec2 worldToChunkCoords(const glm::vec3& worldPos);
 
 
 private:
+    // Sorts nearest first; priority is the distance to the player in chunks.
     struct ChunkTask {
         glm::ivec2 chunkPos;
         float priority;
         bool operator<(const ChunkTask& other) const {
-            return priority > other.priority;
+            return priority < other.priority;
         }
     };
 
+    // Pipeline state of a chunk in load distance. The counts are how many of
+    // the eight surrounding chunks have reached GENERATED and DECORATED.
+    struct ChunkRecord {
+        ChunkGenerationState state = ChunkGenerationState::QUEUED;
+        int generatedNeighbors = 0;
+        int decoratedNeighbors = 0;
+        bool remeshPending = false; // A border changed while the chunk was meshing.
+        bool meshed = false; // Meshed at least once since it was loaded.
+    };
+
     int chunkWidth, chunkHeight, chunkDepth;
     int viewDistance;
     glm::vec3 playerPosition;
     std::unordered_map<glm::ivec2, std::shared_ptr<Chunk>, IVec2Hash> chunks;
-    std::unordered_map<glm::ivec2, ChunkGenerationState, IVec2Hash> chunkStates;
-    std::vector<std::thread> workers;
+    std::unordered_map<glm::ivec2, ChunkRecord, IVec2Hash> chunkRecords;
+    std::vector<glm::ivec2> readyChunks; // Ready for their next stage; drained by updateChunks.
     std::mutex chunksMutex;
-    std::atomic_bool running;
-    ThreadSafeQueue<std::function<void()>> taskQueue;
-    ThreadSafeQueue<std::tuple<glm::ivec2, std::vector<float>, std::vector<unsigned int>, std::vector<float>, std::vector<unsigned int>>> renderQueue;
+    std::unique_ptr<JobSystem> jobs;
+    MpmcQueue<ChunkMeshUpdate> renderQueue;
+    MeshDataPool meshPool;
+    std::vector<glm::ivec2> unloadedChunks; // Guarded by chunksMutex.
     glm::ivec2 lastLoadedCenterChunk;
+    std::atomic<bool> shuttingDown;
+    std::atomic<MeshingMode> meshingMode;
+    MeshingStats meshingStats;
+    std::mutex statsMutex;
 
     void loadChunks();
     void unloadChunks();
-    void startWorkers(size_t numWorkers);
-    void workerFunction();
+    void onChunkGenerated(const glm::ivec2& chunkPos, ChunkRecord& record);
+    void onChunkDecorated(const glm::ivec2& chunkPos, ChunkRecord& record);
+    void queueIfReady(const glm::ivec2& chunkPos, const ChunkRecord& record);
+    bool isReady(const ChunkRecord& record) const;
+    bool isCurrentChunk(const glm::ivec2& chunkPos, const std::shared_ptr<Chunk>& chunk) const;
+    void requestRemesh(const glm::ivec2& chunkPos);
+    MeshData meshChunk(const std::shared_ptr<Chunk>& chunk);
     void expandLoadedArea(const glm::ivec2& newCenterChunk);
     bool isChunkInLoadDistance(const glm::ivec2& chunkPos, const glm::ivec2& centerChunk);
     unsigned int seed;
@@ -0,0 +1,64 @@
+#include "chunk_section.h"
+#include "../voxel/block_properties.h"
+#include <algorithm>
+
+ChunkSection::ChunkSection()
+    : nonAirCount(0), opaqueCount(0) {
+}
+
+void ChunkSection::set(int x, int y, int z, VoxelType type) {
+    VoxelType previous = get(x, y, z);
+    if (previous == type) {
+        return;
+    }
+
+    if (!blocks) {
+        blocks = std::make_unique<PalettedContainer>(VOLUME, AIR);
+    }
+    blocks->set(coordsToIndex(x, y, z), type);
+
+    nonAirCount += (type != AIR) - (previous != AIR);
+    opaqueCount += getBlockProperties(type).occludesFaces - getBlockProperties(previous).occludesFaces;
+
+    if (nonAirCount == 0) {
+        blocks.reset();
+    }
+}
+
+void ChunkSection::load(const VoxelType* values) {
+    nonAirCount = 0;
+    opaqueCount = 0;
+    for (int i = 0; i < VOLUME; ++i) {
+        nonAirCount += values[i] != AIR;
+        opaqueCount += getBlockProperties(values[i]).occludesFaces;
+    }
+
+    if (nonAirCount == 0) {
+        blocks.reset();
+    } else {
+        blocks = std::make_unique<PalettedContainer>(values, VOLUME);
+    }
+}
+
+void ChunkSection::readColumn(int x, int z, VoxelType* out) const {
+    if (!blocks) {
+        std::fill(out, out + SIZE, AIR);
+        return;
+    }
+    int base = coordsToIndex(x, 0, z);
+    for (int y = 0; y < SIZE; ++y) {
+        out[y] = blocks->get(base + y);
+    }
+}
+
+bool ChunkSection::isEmpty() const {
+    return nonAirCount == 0;
+}
+
+bool ChunkSection::isFullyOpaque() const {
+    return opaqueCount == VOLUME;
+}
+
+size_t ChunkSection::getMemoryUsage() const {
+    return sizeof(ChunkSection) + (blocks ? blocks->getMemoryUsage() : 0);
+}
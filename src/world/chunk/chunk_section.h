@@ -0,0 +1,43 @@
+#ifndef CHUNK_SECTION_H
+#define CHUNK_SECTION_H
+
+#include <memory>
+#include <cstdint>
+#include "paletted_container.h"
+#include "../voxel/types.h"
+
+// A 16x16x16 slice of a chunk. All-air sections keep no block storage at all,
+// and the non-air / opaque counters let callers skip or treat them as solid
+// without touching individual blocks.
+class ChunkSection {
+public:
+    static constexpr int SIZE = 16;
+    static constexpr int VOLUME = SIZE * SIZE * SIZE;
+
+    ChunkSection();
+
+    VoxelType get(int x, int y, int z) const {
+        return blocks ? blocks->get(coordsToIndex(x, y, z)) : AIR;
+    }
+
+    void set(int x, int y, int z, VoxelType type);
+    void load(const VoxelType* values);
+    void readColumn(int x, int z, VoxelType* out) const;
+
+    bool isEmpty() const;
+    bool isFullyOpaque() const;
+    size_t getMemoryUsage() const;
+
+    // Y-major: each 16-block column is contiguous, so the mesher's innermost
+    // y loop and vertical neighbour checks walk memory with stride 1.
+    static int coordsToIndex(int x, int y, int z) {
+        return y + z * SIZE + x * SIZE * SIZE;
+    }
+
+private:
+    std::unique_ptr<PalettedContainer> blocks; // nullptr while the section is all air
+    uint16_t nonAirCount;
+    uint16_t opaqueCount;
+};
+
+#endif // CHUNK_SECTION_H
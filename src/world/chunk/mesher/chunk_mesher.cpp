@@ -0,0 +1,609 @@
+#include "chunk_mesher.h"
+#include "section_connectivity.h"
+#include "../chunk_section.h"
+#include "../../voxel/block_properties.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace {
+
+// Axis layout of each cube face. u and v follow the texture coordinates of
+// faceCorners, so merged quads tile the same way as single faces.
+struct FaceDirection {
+    uint8_t flag;
+    glm::ivec3 normal;
+    int axis;
+    int uAxis;
+    int vAxis;
+};
+
+const std::array<FaceDirection, 6> faceDirections = {{
+    {FACE_FRONT,  {0, 0, 1},  2, 0, 1},
+    {FACE_BACK,   {0, 0, -1}, 2, 0, 1},
+    {FACE_LEFT,   {-1, 0, 0}, 0, 2, 1},
+    {FACE_RIGHT,  {1, 0, 0},  0, 2, 1},
+    {FACE_TOP,    {0, 1, 0},  1, 0, 2},
+    {FACE_BOTTOM, {0, -1, 0}, 1, 0, 2}
+}};
+
+const int TOP_FACE = 4; // Index of FACE_TOP in faceDirections.
+
+// Normal per face flag bit: faceDirections order, then the two diagonals.
+// triangle.vert has the same table for packed vertices and face records.
+const std::array<glm::vec3, 8> vertexNormals = {{
+    {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}, {-1.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {1.0f, 1.0f, 1.0f}, {-1.0f, 1.0f, 1.0f}
+}};
+
+// Corner offsets from the block centre per face flag bit, counter-clockwise
+// from the corner with texture coordinate (0, 0). Mirrored in triangle.vert.
+constexpr float faceCorners[8][4][3] = {
+    {{-0.5f, -0.5f,  0.5f}, { 0.5f, -0.5f,  0.5f}, { 0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f}}, // Front
+    {{-0.5f, -0.5f, -0.5f}, { 0.5f, -0.5f, -0.5f}, { 0.5f,  0.5f, -0.5f}, {-0.5f,  0.5f, -0.5f}}, // Back
+    {{-0.5f, -0.5f, -0.5f}, {-0.5f, -0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f, -0.5f}}, // Left
+    {{ 0.5f, -0.5f, -0.5f}, { 0.5f, -0.5f,  0.5f}, { 0.5f,  0.5f,  0.5f}, { 0.5f,  0.5f, -0.5f}}, // Right
+    {{-0.5f,  0.5f, -0.5f}, { 0.5f,  0.5f, -0.5f}, { 0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f}}, // Top
+    {{-0.5f, -0.5f, -0.5f}, { 0.5f, -0.5f, -0.5f}, { 0.5f, -0.5f,  0.5f}, {-0.5f, -0.5f,  0.5f}}, // Bottom
+    {{-0.5f, -0.5f, -0.5f}, { 0.5f, -0.5f,  0.5f}, { 0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f, -0.5f}}, // Diagonal 1
+    {{ 0.5f, -0.5f, -0.5f}, {-0.5f, -0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f}, { 0.5f,  0.5f, -0.5f}}  // Diagonal 2
+};
+
+constexpr float faceTexCoords[4][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+// Which column masks each block type sets: bit 0 cube, 1 occluder, 2 water,
+// 3 X-shaped. Lets the mask fill run without branches.
+const std::array<uint8_t, 256> maskClasses = [] {
+    std::array<uint8_t, 256> classes{};
+    for (int i = 0; i < 256; ++i) {
+        VoxelType type = static_cast<VoxelType>(i);
+        const BlockProperties& properties = getBlockProperties(type);
+        if (properties.isAir) {
+            classes[i] = 0;
+        } else if (properties.isXShaped) {
+            classes[i] = 8;
+        } else if (type == WATER) {
+            classes[i] = 4;
+        } else {
+            classes[i] = properties.occludesFaces ? 3 : 1;
+        }
+    }
+    return classes;
+}();
+
+// Collects bit `bit` of each of the eight bytes into one byte.
+inline uint64_t gatherClassBit(uint64_t classBytes, int bit) {
+    return (((classBytes >> bit) & 0x0101010101010101ull) * 0x0102040810204080ull) >> 56;
+}
+
+} // namespace
+
+ChunkMesher::ChunkMesher(MeshingMode mode)
+    : mode(mode) {
+}
+
+void ChunkMesher::buildMesh(const MeshVolume& volume, const glm::vec3& offset, MeshData& mesh) const {
+    // Reserve the largest sizes this thread has produced so emission never
+    // reallocates mid-mesh. Pooled meshes usually have the capacity already.
+    thread_local std::array<size_t, 2> capacityHints = {};
+    MeshOutput solid{std::move(mesh.solidVertices)};
+    MeshOutput water{std::move(mesh.waterVertices)};
+    solid.vertices.clear();
+    water.vertices.clear();
+    solid.vertices.reserve(capacityHints[0]);
+    water.vertices.reserve(capacityHints[1]);
+
+    // Large enough that it shouldn't live on the stack; kept per thread like the volume.
+    bool binary = mode == MeshingMode::BINARY || mode == MeshingMode::BINARY_GREEDY;
+    thread_local std::unique_ptr<ColumnMasks> columnMasks;
+    if (binary) {
+        if (!columnMasks) {
+            columnMasks = std::make_unique<ColumnMasks>();
+        }
+        fillColumnMasks(volume, *columnMasks);
+    }
+
+    int sectionCount = std::min(volume.getHeight() / ChunkSection::SIZE, MeshData::SECTION_COUNT);
+    for (int sectionY = 0; sectionY < sectionCount; ++sectionY) {
+        if (volume.isSectionEmpty(sectionY)) {
+            // Nothing to add; the section's range stays empty.
+        } else if (mode == MeshingMode::GREEDY) {
+            buildGreedySection(volume, sectionY, offset, solid, water);
+        } else if (binary) {
+            buildBinarySection(volume, *columnMasks, sectionY, offset, solid, water);
+        } else {
+            buildPerFaceSection(volume, sectionY, offset, solid, water);
+        }
+        mesh.solidSectionEnds[sectionY] = static_cast<uint32_t>(solid.vertices.size() / CHUNK_QUAD_WORDS);
+        mesh.waterSectionEnds[sectionY] = static_cast<uint32_t>(water.vertices.size() / CHUNK_QUAD_WORDS);
+        mesh.sectionConnectivity[sectionY] = computeSectionConnectivity(volume, sectionY);
+    }
+    for (int sectionY = sectionCount; sectionY < MeshData::SECTION_COUNT; ++sectionY) {
+        mesh.solidSectionEnds[sectionY] = static_cast<uint32_t>(solid.vertices.size() / CHUNK_QUAD_WORDS);
+        mesh.waterSectionEnds[sectionY] = static_cast<uint32_t>(water.vertices.size() / CHUNK_QUAD_WORDS);
+        mesh.sectionConnectivity[sectionY] = ALL_FACES_CONNECTED;
+    }
+
+    findSolidLayers(volume, mesh);
+
+    capacityHints[0] = std::max(capacityHints[0], solid.vertices.size());
+    capacityHints[1] = std::max(capacityHints[1], water.vertices.size());
+    mesh.solidVertices = std::move(solid.vertices);
+    mesh.waterVertices = std::move(water.vertices);
+}
+
+// Starts from the non-empty sections and drops a layer at the first column
+// with a gap in it, so mostly only layers that are still candidates are read.
+void ChunkMesher::findSolidLayers(const MeshVolume& volume, MeshData& mesh) const {
+    int height = std::min(volume.getHeight(), MeshData::LAYER_WORDS * 64);
+    std::array<uint64_t, MeshData::LAYER_WORDS> layers{};
+    for (int sectionY = 0; sectionY * ChunkSection::SIZE < height; ++sectionY) {
+        if (!volume.isSectionEmpty(sectionY)) {
+            int minY = sectionY * ChunkSection::SIZE;
+            layers[minY / 64] |= ((uint64_t(1) << ChunkSection::SIZE) - 1) << (minY % 64);
+        }
+    }
+
+    for (int x = 0; x < volume.getWidth(); ++x) {
+        for (int z = 0; z < volume.getDepth(); ++z) {
+            const VoxelType* column = volume.getColumn(x, z);
+            for (int word = 0; word < MeshData::LAYER_WORDS; ++word) {
+                for (uint64_t bits = layers[word]; bits != 0; bits &= bits - 1) {
+                    int y = word * 64 + std::countr_zero(bits);
+                    if (!getBlockProperties(column[y]).occludesFaces) {
+                        layers[word] &= ~(uint64_t(1) << (y % 64));
+                    }
+                }
+            }
+        }
+    }
+    mesh.solidLayers = layers;
+}
+
+void ChunkMesher::buildPerFaceSection(const MeshVolume& volume, int sectionY, const glm::vec3& offset,
+                                      MeshOutput& solid, MeshOutput& water) const {
+    // Loop order follows the volume's Y-major layout.
+    int minY = sectionY * ChunkSection::SIZE;
+    for (int x = 0; x < volume.getWidth(); ++x) {
+        for (int z = 0; z < volume.getDepth(); ++z) {
+            for (int y = minY; y < minY + ChunkSection::SIZE; ++y) {
+                VoxelType type = volume.get(x, y, z);
+                if (type != AIR) {
+                    glm::ivec3 pos(x, y, z);
+                    uint8_t faceFlags = getFaceFlags(volume, pos, type);
+                    addBlockFaces(pos, type, faceFlags, offset, getBlockProperties(type).isTranslucent ? water : solid);
+                }
+            }
+        }
+    }
+}
+
+void ChunkMesher::buildGreedySection(const MeshVolume& volume, int sectionY, const glm::vec3& offset,
+                                     MeshOutput& solid, MeshOutput& water) const {
+    const int size = ChunkSection::SIZE;
+    const glm::ivec3 sectionOrigin(0, sectionY * size, 0);
+    std::array<VoxelType, ChunkSection::SIZE * ChunkSection::SIZE> mask;
+
+    for (int face = 0; face < static_cast<int>(faceDirections.size()); ++face) {
+        const FaceDirection& direction = faceDirections[face];
+
+        for (int slice = 0; slice < size; ++slice) {
+            // Visible face types for this slice, indexed by (u, v).
+            for (int v = 0; v < size; ++v) {
+                for (int u = 0; u < size; ++u) {
+                    glm::ivec3 pos = sectionOrigin;
+                    pos[direction.axis] += slice;
+                    pos[direction.uAxis] += u;
+                    pos[direction.vAxis] += v;
+                    mask[u + v * size] = getGreedyFaceType(volume, pos, face);
+                }
+            }
+
+            // Grow each quad along u, then along v while whole rows still match.
+            for (int v = 0; v < size; ++v) {
+                for (int u = 0; u < size; ++u) {
+                    VoxelType type = mask[u + v * size];
+                    if (type == AIR) {
+                        continue;
+                    }
+
+                    int width = 1;
+                    while (u + width < size && mask[u + width + v * size] == type) {
+                        ++width;
+                    }
+
+                    int height = 1;
+                    for (; v + height < size; ++height) {
+                        bool rowMatches = true;
+                        for (int k = u; k < u + width; ++k) {
+                            if (mask[k + (v + height) * size] != type) {
+                                rowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!rowMatches) {
+                            break;
+                        }
+                    }
+
+                    for (int dv = 0; dv < height; ++dv) {
+                        for (int du = 0; du < width; ++du) {
+                            mask[u + du + (v + dv) * size] = AIR;
+                        }
+                    }
+
+                    glm::ivec3 pos = sectionOrigin;
+                    pos[direction.axis] += slice;
+                    pos[direction.uAxis] += u;
+                    pos[direction.vAxis] += v;
+                    addQuad(face, pos, width, height, type, offset,
+                            getBlockProperties(type).isTranslucent ? water : solid);
+                }
+            }
+        }
+    }
+
+    // X-shaped plants don't tile, so they are emitted one by one.
+    for (int x = 0; x < volume.getWidth(); ++x) {
+        for (int z = 0; z < volume.getDepth(); ++z) {
+            for (int y = sectionOrigin.y; y < sectionOrigin.y + size; ++y) {
+                VoxelType type = volume.get(x, y, z);
+                if (getBlockProperties(type).isXShaped) {
+                    addBlockFaces(glm::ivec3(x, y, z), type, FACE_DIAGONAL_1 | FACE_DIAGONAL_2, offset, solid);
+                }
+            }
+        }
+    }
+}
+
+// Bitmask paths assume a 16x256x16 volume: columns are one section wide and
+// four 64-bit words tall.
+void ChunkMesher::fillColumnMasks(const MeshVolume& volume, ColumnMasks& masks) const {
+    std::memset(&masks, 0, sizeof(masks));
+    const int size = ChunkSection::SIZE;
+    const int sectionsPerWord = 64 / size;
+
+    for (int x = -1; x <= size; ++x) {
+        for (int z = -1; z <= size; ++z) {
+            if ((x < 0 || x >= size) && (z < 0 || z >= size)) {
+                continue; // Corner columns never touch a face of this chunk.
+            }
+
+            const VoxelType* column = volume.getColumn(x, z);
+            for (int word = 0; word < COLUMN_WORDS; ++word) {
+                uint64_t cube = 0, occluder = 0, water = 0, xShaped = 0;
+                for (int section = 0; section < sectionsPerWord; ++section) {
+                    // Empty sections of this chunk can't own faces, and their
+                    // cells are air, so zero bits are already correct.
+                    int sectionY = word * sectionsPerWord + section;
+                    if (volume.isSectionEmpty(sectionY)) {
+                        continue;
+                    }
+                    const VoxelType* cells = column + sectionY * size;
+                    for (int y = 0; y < size; y += 8) {
+                        uint64_t classBytes = 0;
+                        for (int i = 0; i < 8; ++i) {
+                            classBytes |= uint64_t(maskClasses[cells[y + i]]) << (i * 8);
+                        }
+                        int bit = section * size + y;
+                        cube |= gatherClassBit(classBytes, 0) << bit;
+                        occluder |= gatherClassBit(classBytes, 1) << bit;
+                        water |= gatherClassBit(classBytes, 2) << bit;
+                        xShaped |= gatherClassBit(classBytes, 3) << bit;
+                    }
+                }
+                masks.cube[x + 1][z + 1][word] = cube;
+                masks.occluder[x + 1][z + 1][word] = occluder;
+                masks.water[x + 1][z + 1][word] = water;
+                masks.xShaped[x + 1][z + 1][word] = xShaped;
+            }
+        }
+    }
+}
+
+// Visible faces of a column come from shifts and ANDs on whole 64-cell words:
+// side faces against the neighbouring column, vertical faces against the same
+// column shifted by one with the carry bit taken from the adjacent word.
+void ChunkMesher::buildBinarySection(const MeshVolume& volume, const ColumnMasks& masks, int sectionY,
+                                     const glm::vec3& offset, MeshOutput& solid, MeshOutput& water) const {
+    const int size = ChunkSection::SIZE;
+    const int word = sectionY * size / 64;
+    const int shift = sectionY * size % 64;
+    const glm::ivec3 sectionOrigin(0, sectionY * size, 0);
+    const bool greedy = mode == MeshingMode::BINARY_GREEDY;
+
+    // Per face direction, 16 slices of 16x16 bits (u + v * 16) for the greedy pass.
+    uint64_t planes[6][ChunkSection::SIZE][4];
+    uint64_t waterPlanes[ChunkSection::SIZE][4];
+    if (greedy) {
+        std::memset(planes, 0, sizeof(planes));
+        std::memset(waterPlanes, 0, sizeof(waterPlanes));
+    }
+
+    for (int x = 0; x < size; ++x) {
+        for (int z = 0; z < size; ++z) {
+            uint64_t cube = masks.cube[x + 1][z + 1][word];
+            uint64_t waterCells = masks.water[x + 1][z + 1][word];
+            if ((cube | waterCells) == 0) {
+                continue;
+            }
+
+            uint64_t occluder = masks.occluder[x + 1][z + 1][word];
+            uint64_t occluderAbove = word + 1 < COLUMN_WORDS ? masks.occluder[x + 1][z + 1][word + 1] << 63 : 0;
+            uint64_t occluderBelow = word > 0 ? masks.occluder[x + 1][z + 1][word - 1] >> 63 : 0;
+            uint64_t waterAbove = word + 1 < COLUMN_WORDS ? masks.water[x + 1][z + 1][word + 1] << 63 : 0;
+
+            // Same order as faceDirections.
+            uint64_t faces[6] = {
+                cube & ~masks.occluder[x + 1][z + 2][word],
+                cube & ~masks.occluder[x + 1][z][word],
+                cube & ~masks.occluder[x][z + 1][word],
+                cube & ~masks.occluder[x + 2][z + 1][word],
+                cube & ~((occluder >> 1) | occluderAbove),
+                cube & ~((occluder << 1) | occluderBelow)
+            };
+            uint64_t waterTop = waterCells & ~((waterCells >> 1) | waterAbove);
+
+            for (int face = 0; face < 6; ++face) {
+                const FaceDirection& direction = faceDirections[face];
+                for (uint32_t bits = static_cast<uint32_t>(faces[face] >> shift) & 0xFFFF; bits != 0; bits &= bits - 1) {
+                    int y = std::countr_zero(bits);
+                    glm::ivec3 pos(x, sectionOrigin.y + y, z);
+                    if (greedy) {
+                        glm::ivec3 local(x, y, z);
+                        int cell = local[direction.uAxis] + local[direction.vAxis] * size;
+                        planes[face][local[direction.axis]][cell >> 6] |= uint64_t(1) << (cell & 63);
+                    } else {
+                        addQuad(face, pos, 1, 1, volume.get(pos.x, pos.y, pos.z), offset, solid);
+                    }
+                }
+            }
+
+            for (uint32_t bits = static_cast<uint32_t>(waterTop >> shift) & 0xFFFF; bits != 0; bits &= bits - 1) {
+                int y = std::countr_zero(bits);
+                if (greedy) {
+                    int cell = x + z * size;
+                    waterPlanes[y][cell >> 6] |= uint64_t(1) << (cell & 63);
+                } else {
+                    addQuad(TOP_FACE, glm::ivec3(x, sectionOrigin.y + y, z), 1, 1, WATER, offset, water);
+                }
+            }
+
+            for (uint32_t bits = static_cast<uint32_t>(masks.xShaped[x + 1][z + 1][word] >> shift) & 0xFFFF; bits != 0; bits &= bits - 1) {
+                glm::ivec3 pos(x, sectionOrigin.y + std::countr_zero(bits), z);
+                addBlockFaces(pos, volume.get(pos.x, pos.y, pos.z), FACE_DIAGONAL_1 | FACE_DIAGONAL_2, offset, solid);
+            }
+        }
+    }
+
+    if (!greedy) {
+        return;
+    }
+
+    for (int face = 0; face < 6; ++face) {
+        for (int slice = 0; slice < size; ++slice) {
+            const uint64_t* plane = planes[face][slice];
+            if ((plane[0] | plane[1] | plane[2] | plane[3]) == 0) {
+                continue;
+            }
+            glm::ivec3 sliceOrigin = sectionOrigin;
+            sliceOrigin[faceDirections[face].axis] += slice;
+            emitGreedyFaceMask(volume, plane, face, sliceOrigin, offset, solid);
+        }
+    }
+
+    for (int y = 0; y < size; ++y) {
+        const uint64_t* plane = waterPlanes[y];
+        if ((plane[0] | plane[1] | plane[2] | plane[3]) != 0) {
+            emitGreedyFaceMask(volume, plane, TOP_FACE, sectionOrigin + glm::ivec3(0, y, 0), offset, water);
+        }
+    }
+}
+
+// Splits the visible faces into 16-bit row masks per block type, then merges
+// each type's rows: take the lowest run in a row, then absorb following rows
+// while they contain the whole run.
+void ChunkMesher::emitGreedyFaceMask(const MeshVolume& volume, const uint64_t* faces, int face, const glm::ivec3& sliceOrigin,
+                                     const glm::vec3& offset, MeshOutput& output) const {
+    const int size = ChunkSection::SIZE;
+    const FaceDirection& direction = faceDirections[face];
+
+    struct TypeRows {
+        VoxelType type;
+        uint16_t rows[ChunkSection::SIZE];
+    };
+    std::array<TypeRows, 8> groups;
+    int groupCount = 0;
+
+    auto cellPosition = [&](int u, int v) {
+        glm::ivec3 pos = sliceOrigin;
+        pos[direction.uAxis] += u;
+        pos[direction.vAxis] += v;
+        return pos;
+    };
+
+    uint64_t remaining[4] = {faces[0], faces[1], faces[2], faces[3]};
+    bool done = false;
+    while (!done) {
+        // Gather up to groups.size() types per pass; a slice rarely shows more.
+        groupCount = 0;
+        for (int word = 0; word < 4; ++word) {
+            for (uint64_t bits = remaining[word]; bits != 0; bits &= bits - 1) {
+                int cell = word * 64 + std::countr_zero(bits);
+                glm::ivec3 pos = cellPosition(cell & 15, cell >> 4);
+                VoxelType type = volume.get(pos.x, pos.y, pos.z);
+
+                int group = 0;
+                while (group < groupCount && groups[group].type != type) {
+                    ++group;
+                }
+                if (group == groupCount) {
+                    if (groupCount == static_cast<int>(groups.size())) {
+                        continue;
+                    }
+                    groups[groupCount].type = type;
+                    std::memset(groups[groupCount].rows, 0, sizeof(groups[groupCount].rows));
+                    ++groupCount;
+                }
+                groups[group].rows[cell >> 4] |= uint16_t(1) << (cell & 15);
+                remaining[word] &= ~(uint64_t(1) << (cell & 63));
+            }
+        }
+        done = (remaining[0] | remaining[1] | remaining[2] | remaining[3]) == 0;
+
+        for (int group = 0; group < groupCount; ++group) {
+            uint16_t* rows = groups[group].rows;
+            for (int v = 0; v < size; ++v) {
+                while (rows[v] != 0) {
+                    int u = std::countr_zero(rows[v]);
+                    int width = std::countr_one(static_cast<uint16_t>(rows[v] >> u));
+                    uint16_t run = static_cast<uint16_t>(((1u << width) - 1) << u);
+
+                    int height = 1;
+                    while (v + height < size && (rows[v + height] & run) == run) {
+                        rows[v + height] &= ~run;
+                        ++height;
+                    }
+                    rows[v] &= ~run;
+
+                    addQuad(face, cellPosition(u, v), width, height, groups[group].type, offset, output);
+                }
+            }
+        }
+    }
+}
+
+// Type of the face a block shows in the given direction, or AIR if it's hidden
+// or belongs to a block that isn't meshed as a cube.
+VoxelType ChunkMesher::getGreedyFaceType(const MeshVolume& volume, const glm::ivec3& pos, int face) const {
+    VoxelType type = volume.get(pos.x, pos.y, pos.z);
+    if (type == AIR || getBlockProperties(type).isXShaped) {
+        return AIR;
+    }
+
+    const FaceDirection& direction = faceDirections[face];
+    glm::ivec3 neighborPos = pos + direction.normal;
+    VoxelType neighbor = volume.get(neighborPos.x, neighborPos.y, neighborPos.z);
+
+    if (type == WATER) {
+        return direction.flag == FACE_TOP && neighbor != WATER ? WATER : AIR;
+    }
+    return shouldRenderFace(neighbor) ? type : AIR;
+}
+
+// Positions are world space; packed vertices store them relative to the chunk
+// origin (offset) and the shader adds it back from a uniform.
+void ChunkMesher::appendVertex(MeshOutput& output, const glm::vec3& position, const glm::vec2& texCoord,
+                               int normalIndex, VoxelType type, float ao, const glm::vec3& offset) const {
+    if (CHUNK_MESH_FORMAT == CHUNK_MESH_PACKED) {
+        glm::ivec3 corner = glm::ivec3(glm::round(position - offset + glm::vec3(0.5f)));
+        glm::ivec2 uv = glm::ivec2(glm::round(texCoord));
+        output.vertices.push_back(static_cast<uint32_t>(corner.x) | static_cast<uint32_t>(corner.y) << 5 |
+                                  static_cast<uint32_t>(corner.z) << 14 | static_cast<uint32_t>(normalIndex) << 19 |
+                                  static_cast<uint32_t>(uv.x) << 22 | static_cast<uint32_t>(uv.y) << 27);
+        output.vertices.push_back(static_cast<uint32_t>(type) | static_cast<uint32_t>(ao * 255.0f + 0.5f) << 8);
+        return;
+    }
+
+    const glm::vec3& normal = vertexNormals[normalIndex];
+    for (float value : {position.x, position.y, position.z, texCoord.x, texCoord.y,
+                        normal.x, normal.y, normal.z, static_cast<float>(type), ao}) {
+        output.vertices.push_back(std::bit_cast<uint32_t>(value));
+    }
+}
+
+// pos is chunk-local; the shader adds the chunk origin.
+void ChunkMesher::appendFaceRecord(MeshOutput& output, const glm::ivec3& pos, int face, VoxelType type, float ao) const {
+    uint32_t aoLevel = static_cast<uint32_t>((1.0f - ao) * 3.0f + 0.5f);
+    output.vertices.push_back(static_cast<uint32_t>(pos.x) | static_cast<uint32_t>(pos.y) << 4 |
+                              static_cast<uint32_t>(pos.z) << 12 | static_cast<uint32_t>(face) << 16 |
+                              static_cast<uint32_t>(type) << 19 | aoLevel << 27);
+}
+
+// Emits a width x height quad whose minimum corner is the block at pos. Texture
+// coordinates run past 1 so the shader can repeat the tile across the quad.
+void ChunkMesher::addQuad(int face, const glm::ivec3& pos, int width, int height, VoxelType type,
+                          const glm::vec3& offset, MeshOutput& output) const {
+    const FaceDirection& direction = faceDirections[face];
+    if (FACE_RECORD_MESHES) {
+        for (int dv = 0; dv < height; ++dv) {
+            for (int du = 0; du < width; ++du) {
+                glm::ivec3 cell = pos;
+                cell[direction.uAxis] += du;
+                cell[direction.vAxis] += dv;
+                appendFaceRecord(output, cell, face, type, 1.0f);
+            }
+        }
+        return;
+    }
+
+    glm::vec3 origin = glm::vec3(pos) + offset - glm::vec3(0.5f);
+    origin[direction.axis] = pos[direction.axis] + offset[direction.axis] + 0.5f * direction.normal[direction.axis];
+
+    glm::vec3 uStep(0.0f);
+    glm::vec3 vStep(0.0f);
+    uStep[direction.uAxis] = static_cast<float>(width);
+    vStep[direction.vAxis] = static_cast<float>(height);
+
+    const std::array<glm::vec3, 4> corners = {origin, origin + uStep, origin + uStep + vStep, origin + vStep};
+    const std::array<glm::vec2, 4> texCoords = {
+        glm::vec2(0.0f, 0.0f), glm::vec2(width, 0.0f), glm::vec2(width, height), glm::vec2(0.0f, height)
+    };
+
+    for (int i = 0; i < 4; ++i) {
+        appendVertex(output, corners[i], texCoords[i], face, type, 1.0f, offset);
+    }
+}
+
+uint8_t ChunkMesher::getFaceFlags(const MeshVolume& volume, const glm::ivec3& pos, VoxelType type) const {
+    uint8_t flags = 0;
+
+    if (getBlockProperties(type).isXShaped) {
+        return FACE_DIAGONAL_1 | FACE_DIAGONAL_2;
+    }
+
+    if (type == WATER) {
+        // The volume pads above the chunk with air, so the top layer is always exposed.
+        return volume.get(pos.x, pos.y + 1, pos.z) != WATER ? FACE_TOP : 0;
+    }
+
+    flags |= checkFace(volume, pos, {0, 1, 0}, FACE_TOP);
+    flags |= checkFace(volume, pos, {0, -1, 0}, FACE_BOTTOM);
+    flags |= checkFace(volume, pos, {0, 0, 1}, FACE_FRONT);
+    flags |= checkFace(volume, pos, {0, 0, -1}, FACE_BACK);
+    flags |= checkFace(volume, pos, {-1, 0, 0}, FACE_LEFT);
+    flags |= checkFace(volume, pos, {1, 0, 0}, FACE_RIGHT);
+
+    return flags;
+}
+
+uint8_t ChunkMesher::checkFace(const MeshVolume& volume, const glm::ivec3& pos, const glm::ivec3& offset, uint8_t faceFlag) const {
+    glm::ivec3 neighborPos = pos + offset;
+    return shouldRenderFace(volume.get(neighborPos.x, neighborPos.y, neighborPos.z)) ? faceFlag : 0;
+}
+
+bool ChunkMesher::shouldRenderFace(VoxelType type) const {
+    return !getBlockProperties(type).occludesFaces;
+    // Transparent voxels should not cause faces to be hidden.
+    // Optimise leaves to occlude each other later.
+}
+
+// Emits unit faces from the constexpr templates, one per set flag bit.
+void ChunkMesher::addBlockFaces(const glm::ivec3& pos, VoxelType type, uint8_t faceFlags,
+                                const glm::vec3& offset, MeshOutput& output) const {
+    glm::vec3 center = glm::vec3(pos) + offset;
+    for (uint32_t bits = faceFlags; bits != 0; bits &= bits - 1) {
+        int face = std::countr_zero(bits);
+        if (FACE_RECORD_MESHES) {
+            appendFaceRecord(output, pos, face, type, 1.0f);
+            continue;
+        }
+        for (int corner = 0; corner < 4; ++corner) {
+            const float* cornerOffset = faceCorners[face][corner];
+            glm::vec3 position = center + glm::vec3(cornerOffset[0], cornerOffset[1], cornerOffset[2]);
+            glm::vec2 texCoord(faceTexCoords[corner][0], faceTexCoords[corner][1]);
+            appendVertex(output, position, texCoord, face, type, 1.0f, offset);
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef CHUNK_MESHER_H
+#define CHUNK_MESHER_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "mesh_volume.h"
+#include "mesh_data.h"
+#include "../../voxel/voxel.h"
+#include "../../../global.h"
+
+enum class MeshingMode {
+    PER_FACE, // One quad per visible voxel face.
+    GREEDY,   // Coplanar faces of the same type merged into larger quads.
+    BINARY,   // Per-face output, visibility found with 64-bit occupancy masks.
+    BINARY_GREEDY // Bitmask visibility plus greedy merging on 16-bit row masks.
+};
+
+struct MeshingStats {
+    uint64_t meshes = 0;
+    uint64_t quads = 0;
+    uint64_t bytes = 0;
+    uint64_t microseconds = 0;
+    // Allocations: meshes that found the pool empty, and pooled meshes whose
+    // vertex buffers still had to grow.
+    uint64_t poolMisses = 0;
+    uint64_t bufferGrowths = 0;
+    // Lifetime counters, kept when the meshing mode changes.
+    uint64_t chunksLoaded = 0;
+    uint64_t totalMeshes = 0;
+    uint64_t remeshes = 0; // Meshes of a chunk that was already meshed.
+};
+
+// Chunk mesh buffers hold 32-bit words, laid out per CHUNK_MESH_FORMAT and
+// decoded in triangle.vert:
+// - CHUNK_MESH_PACKED: two words per vertex,
+//     word 0: x 0-4, y 5-13, z 14-18 (chunk-local corner, +0.5), normal 19-21,
+//             u 22-26, v 27-31
+//     word 1: type 0-7, AO 8-15
+// - CHUNK_MESH_FLOAT: ten floats per vertex stored bit for bit: position, UV,
+//   normal, type, AO.
+// - CHUNK_MESH_FACE_RECORDS: one word per unit face,
+//     x 0-3, y 4-11, z 12-15 (chunk-local block), face 16-18, type 19-26,
+//     AO level 27-28 (0 is unoccluded), 29-31 unused
+//   There is no room for a quad size, so greedy quads are written back out as
+//   the unit faces they cover.
+constexpr bool FACE_RECORD_MESHES = CHUNK_MESH_FORMAT == CHUNK_MESH_FACE_RECORDS;
+constexpr int CHUNK_VERTEX_WORDS = CHUNK_MESH_FORMAT == CHUNK_MESH_PACKED ? 2 : 10;
+constexpr int CHUNK_QUAD_WORDS = FACE_RECORD_MESHES ? 1 : CHUNK_VERTEX_WORDS * 4;
+
+// Builds solid and water meshes from a MeshVolume snapshot.
+class ChunkMesher {
+public:
+    explicit ChunkMesher(MeshingMode mode = MeshingMode::PER_FACE);
+    // Replaces the contents of mesh, reusing its capacity. CHUNK_QUAD_WORDS
+    // words per quad; vertex formats are drawn with the renderer's shared
+    // quad index buffer.
+    void buildMesh(const MeshVolume& volume, const glm::vec3& offset, MeshData& mesh) const;
+
+private:
+    struct MeshOutput {
+        std::vector<uint32_t> vertices;
+    };
+
+    void findSolidLayers(const MeshVolume& volume, MeshData& mesh) const;
+    void buildPerFaceSection(const MeshVolume& volume, int sectionY, const glm::vec3& offset,
+                             MeshOutput& solid, MeshOutput& water) const;
+    void buildGreedySection(const MeshVolume& volume, int sectionY, const glm::vec3& offset,
+                            MeshOutput& solid, MeshOutput& water) const;
+    // Occupancy of every column in the volume, padding included, as 64-bit
+    // words along Y. Word w of a column holds y = w * 64 .. w * 64 + 63.
+    static constexpr int COLUMN_WORDS = 4;
+    struct ColumnMasks {
+        uint64_t cube[18][18][COLUMN_WORDS];
+        uint64_t occluder[18][18][COLUMN_WORDS];
+        uint64_t water[18][18][COLUMN_WORDS];
+        uint64_t xShaped[18][18][COLUMN_WORDS];
+    };
+
+    void fillColumnMasks(const MeshVolume& volume, ColumnMasks& masks) const;
+    void buildBinarySection(const MeshVolume& volume, const ColumnMasks& masks, int sectionY,
+                            const glm::vec3& offset, MeshOutput& solid, MeshOutput& water) const;
+    void emitGreedyFaceMask(const MeshVolume& volume, const uint64_t* faces, int face, const glm::ivec3& sliceOrigin,
+                            const glm::vec3& offset, MeshOutput& output) const;
+    VoxelType getGreedyFaceType(const MeshVolume& volume, const glm::ivec3& pos, int face) const;
+    void appendVertex(MeshOutput& output, const glm::vec3& position, const glm::vec2& texCoord,
+                      int normalIndex, VoxelType type, float ao, const glm::vec3& offset) const;
+    void appendFaceRecord(MeshOutput& output, const glm::ivec3& pos, int face, VoxelType type, float ao) const;
+    void addQuad(int face, const glm::ivec3& pos, int width, int height, VoxelType type,
+                 const glm::vec3& offset, MeshOutput& output) const;
+
+    uint8_t getFaceFlags(const MeshVolume& volume, const glm::ivec3& pos, VoxelType type) const;
+    uint8_t checkFace(const MeshVolume& volume, const glm::ivec3& pos, const glm::ivec3& offset, uint8_t faceFlag) const;
+    bool shouldRenderFace(VoxelType type) const;
+    void addBlockFaces(const glm::ivec3& pos, VoxelType type, uint8_t faceFlags,
+                       const glm::vec3& offset, MeshOutput& output) const;
+
+    MeshingMode mode;
+};
+
+#endif // CHUNK_MESHER_H
@@ -0,0 +1,80 @@
+#ifndef MESH_DATA_H
+#define MESH_DATA_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include "../chunk_section.h"
+#include "../../../global.h"
+#include "../../../utils/lock_free_queue.h"
+
+// Solid and water mesh words for one chunk, see chunk_mesher.h for the
+// layout. Move-only, so a mesh travels from the worker that builds it to
+// glBufferData without being copied.
+class MeshData {
+public:
+    static constexpr int SECTION_COUNT = static_cast<int>(CHUNK_HEIGHT) / ChunkSection::SIZE;
+    static constexpr int LAYER_WORDS = (static_cast<int>(CHUNK_HEIGHT) + 63) / 64;
+
+    MeshData() = default;
+    MeshData(MeshData&&) noexcept = default;
+    MeshData& operator=(MeshData&&) noexcept = default;
+    MeshData(const MeshData&) = delete;
+    MeshData& operator=(const MeshData&) = delete;
+
+    bool empty() const {
+        return solidVertices.empty() && waterVertices.empty();
+    }
+
+    size_t byteSize() const {
+        return (solidVertices.size() + waterVertices.size()) * sizeof(uint32_t);
+    }
+
+    // Keeps the capacity for the next mesh.
+    void clear() {
+        solidVertices.clear();
+        waterVertices.clear();
+        solidSectionEnds.fill(0);
+        waterSectionEnds.fill(0);
+        solidLayers.fill(0);
+        sectionConnectivity.fill(0);
+    }
+
+    std::vector<uint32_t> solidVertices;
+    std::vector<uint32_t> waterVertices;
+    // Quads are written one section at a time, bottom up. Entry s is the quad
+    // count once section s is done, so its quads are [ends[s - 1], ends[s])
+    // and it lies within y = s * 16 .. s * 16 + 16.
+    std::array<uint32_t, SECTION_COUNT> solidSectionEnds{};
+    std::array<uint32_t, SECTION_COUNT> waterSectionEnds{};
+    // Bit y is set when every column of the chunk has a face-occluding block
+    // at y. Runs of set bits are solid slabs the renderer can occlude with.
+    std::array<uint64_t, LAYER_WORDS> solidLayers{};
+    // Per section, the pairs of faces joined through open blocks; see
+    // section_connectivity.h.
+    std::array<uint16_t, SECTION_COUNT> sectionConnectivity{};
+};
+
+// Recycles MeshData buffers after upload so meshing rarely allocates. Workers
+// acquire, the main thread releases; buffers past the pool size are freed.
+class MeshDataPool {
+public:
+    explicit MeshDataPool(size_t size)
+        : freeMeshes(size) {
+    }
+
+    // False on a miss: the pool was empty and mesh is left without buffers.
+    bool acquire(MeshData& mesh) {
+        return freeMeshes.tryPop(mesh);
+    }
+
+    void release(MeshData&& mesh) {
+        mesh.clear();
+        freeMeshes.tryPush(std::move(mesh));
+    }
+
+private:
+    MpmcQueue<MeshData> freeMeshes;
+};
+
+#endif // MESH_DATA_H
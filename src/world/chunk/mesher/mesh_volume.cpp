@@ -0,0 +1,59 @@
+#include "mesh_volume.h"
+#include "../chunk.h"
+#include <algorithm>
+
+MeshVolume::MeshVolume(int width, int height, int depth)
+    : width(width), height(height), depth(depth),
+      blocks((width + 2) * (height + 2) * (depth + 2), AIR),
+      nonEmptySections(0) {
+}
+
+void MeshVolume::fill(const Chunk& chunk, const std::array<std::shared_ptr<Chunk>, 4>& neighbors) {
+    nonEmptySections = chunk.copyColumns({0, 0}, {width, depth}, *this, {0, 0});
+
+    // Each neighbour contributes the single row of columns touching this chunk.
+    // Missing neighbours leave air, which keeps faces on unloaded borders visible.
+    struct Border {
+        glm::ivec2 min, max, offset;
+    };
+    const std::array<Border, 4> borders = {{
+        {{0, 0}, {1, depth}, {width, 0}},              // NEIGHBOR_POS_X
+        {{width - 1, 0}, {width, depth}, {-width, 0}}, // NEIGHBOR_NEG_X
+        {{0, 0}, {width, 1}, {0, depth}},              // NEIGHBOR_POS_Z
+        {{0, depth - 1}, {width, depth}, {0, -depth}}  // NEIGHBOR_NEG_Z
+    }};
+
+    for (size_t i = 0; i < borders.size(); ++i) {
+        const Border& border = borders[i];
+        if (neighbors[i]) {
+            neighbors[i]->copyColumns(border.min, border.max, *this, border.offset);
+        } else {
+            clearColumns(border.min + border.offset, border.max + border.offset);
+        }
+    }
+}
+
+bool MeshVolume::isSectionEmpty(int sectionY) const {
+    return (nonEmptySections & (1u << sectionY)) == 0;
+}
+
+int MeshVolume::getWidth() const {
+    return width;
+}
+
+int MeshVolume::getHeight() const {
+    return height;
+}
+
+int MeshVolume::getDepth() const {
+    return depth;
+}
+
+void MeshVolume::clearColumns(const glm::ivec2& min, const glm::ivec2& max) {
+    for (int x = min.x; x < max.x; ++x) {
+        for (int z = min.y; z < max.y; ++z) {
+            VoxelType* column = getColumn(x, z);
+            std::fill(column, column + height, AIR);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef MESH_VOLUME_H
+#define MESH_VOLUME_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "../../voxel/types.h"
+
+class Chunk;
+
+// Neighbour slots passed to MeshVolume::fill.
+enum MeshNeighbor {
+    NEIGHBOR_POS_X,
+    NEIGHBOR_NEG_X,
+    NEIGHBOR_POS_Z,
+    NEIGHBOR_NEG_Z
+};
+
+// Snapshot of a chunk plus a one-voxel border taken from its four horizontal
+// neighbours. Meshing reads only from here, so it needs no chunk locks and no
+// ChunkManager lookups. Coordinates are chunk-local and valid from -1 to size.
+class MeshVolume {
+public:
+    MeshVolume(int width, int height, int depth);
+
+    void fill(const Chunk& chunk, const std::array<std::shared_ptr<Chunk>, 4>& neighbors);
+
+    VoxelType get(int x, int y, int z) const {
+        return blocks[coordsToIndex(x, y, z)];
+    }
+
+    VoxelType* getColumn(int x, int z) {
+        return &blocks[coordsToIndex(x, 0, z)];
+    }
+
+    // Column reads stay valid one past either end, like get().
+    const VoxelType* getColumn(int x, int z) const {
+        return &blocks[coordsToIndex(x, 0, z)];
+    }
+
+    bool isSectionEmpty(int sectionY) const;
+    int getWidth() const;
+    int getHeight() const;
+    int getDepth() const;
+
+private:
+    int coordsToIndex(int x, int y, int z) const {
+        return (y + 1) + ((z + 1) + (x + 1) * (depth + 2)) * (height + 2);
+    }
+
+    void clearColumns(const glm::ivec2& min, const glm::ivec2& max);
+
+    int width, height, depth;
+    std::vector<VoxelType> blocks;
+    uint32_t nonEmptySections;
+};
+
+#endif // MESH_VOLUME_H
@@ -0,0 +1,96 @@
+#include "section_connectivity.h"
+#include "mesh_volume.h"
+#include "../chunk_section.h"
+#include "../../voxel/block_properties.h"
+#include <array>
+
+namespace {
+
+constexpr int SIZE = ChunkSection::SIZE;
+constexpr int CELLS = ChunkSection::VOLUME;
+
+int cellIndex(int x, int y, int z) {
+    return y + (z + x * SIZE) * SIZE;
+}
+
+uint8_t touchedFaces(int x, int y, int z) {
+    uint8_t faces = 0;
+    faces |= (x == 0) << SECTION_NEG_X;
+    faces |= (x == SIZE - 1) << SECTION_POS_X;
+    faces |= (y == 0) << SECTION_NEG_Y;
+    faces |= (y == SIZE - 1) << SECTION_POS_Y;
+    faces |= (z == 0) << SECTION_NEG_Z;
+    faces |= (z == SIZE - 1) << SECTION_POS_Z;
+    return faces;
+}
+
+} // namespace
+
+// Each open region is filled once; every pair of faces it reaches becomes
+// connected. Stops early once all pairs are.
+uint16_t computeSectionConnectivity(const MeshVolume& volume, int sectionY) {
+    if (volume.isSectionEmpty(sectionY)) {
+        return ALL_FACES_CONNECTED;
+    }
+
+    // Set for blocks that can't be walked through; filled cells are added.
+    std::array<uint64_t, CELLS / 64> closed{};
+    int minY = sectionY * SIZE;
+    for (int x = 0; x < SIZE; ++x) {
+        for (int z = 0; z < SIZE; ++z) {
+            const VoxelType* column = volume.getColumn(x, z) + minY;
+            for (int y = 0; y < SIZE; ++y) {
+                if (getBlockProperties(column[y]).occludesFaces) {
+                    int index = cellIndex(x, y, z);
+                    closed[index / 64] |= uint64_t(1) << (index % 64);
+                }
+            }
+        }
+    }
+
+    auto isClosed = [&](int index) { return (closed[index / 64] >> (index % 64)) & 1; };
+    auto close = [&](int index) { closed[index / 64] |= uint64_t(1) << (index % 64); };
+
+    uint16_t connectivity = 0;
+    std::array<uint16_t, CELLS> stack;
+    for (int start = 0; start < CELLS && connectivity != ALL_FACES_CONNECTED; ++start) {
+        if (isClosed(start)) {
+            continue;
+        }
+
+        uint8_t faces = 0;
+        int stackSize = 0;
+        stack[stackSize++] = static_cast<uint16_t>(start);
+        close(start);
+        while (stackSize > 0) {
+            int index = stack[--stackSize];
+            int y = index % SIZE;
+            int z = (index / SIZE) % SIZE;
+            int x = index / (SIZE * SIZE);
+            faces |= touchedFaces(x, y, z);
+
+            const int neighbors[6][3] = {{x - 1, y, z}, {x + 1, y, z}, {x, y - 1, z},
+                                         {x, y + 1, z}, {x, y, z - 1}, {x, y, z + 1}};
+            for (const auto& neighbor : neighbors) {
+                if (neighbor[0] < 0 || neighbor[0] >= SIZE || neighbor[1] < 0 || neighbor[1] >= SIZE ||
+                    neighbor[2] < 0 || neighbor[2] >= SIZE) {
+                    continue;
+                }
+                int next = cellIndex(neighbor[0], neighbor[1], neighbor[2]);
+                if (!isClosed(next)) {
+                    close(next);
+                    stack[stackSize++] = static_cast<uint16_t>(next);
+                }
+            }
+        }
+
+        for (int a = 0; a < SECTION_FACE_COUNT; ++a) {
+            for (int b = a + 1; b < SECTION_FACE_COUNT; ++b) {
+                if ((faces >> a & 1) && (faces >> b & 1)) {
+                    connectivity |= 1 << sectionFacePairBit(a, b);
+                }
+            }
+        }
+    }
+    return connectivity;
+}
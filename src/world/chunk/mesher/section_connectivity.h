@@ -0,0 +1,44 @@
+#ifndef SECTION_CONNECTIVITY_H
+#define SECTION_CONNECTIVITY_H
+
+#include <cstdint>
+
+class MeshVolume;
+
+// Which pairs of a 16x16x16 section's six faces are joined through blocks
+// that don't occlude faces. One bit per unordered pair of different faces;
+// the renderer only walks through a section between faces that are joined.
+enum SectionFace {
+    SECTION_NEG_X,
+    SECTION_POS_X,
+    SECTION_NEG_Y,
+    SECTION_POS_Y,
+    SECTION_NEG_Z,
+    SECTION_POS_Z,
+    SECTION_FACE_COUNT
+};
+
+constexpr uint16_t ALL_FACES_CONNECTED = 0x7FFF;
+
+constexpr int oppositeSectionFace(int face) {
+    return face ^ 1;
+}
+
+constexpr int sectionFacePairBit(int a, int b) {
+    if (a > b) {
+        int swap = a;
+        a = b;
+        b = swap;
+    }
+    // Pairs (0,1)..(0,5), (1,2)..(1,5), ... numbered in order.
+    return a * (2 * SECTION_FACE_COUNT - a - 1) / 2 + (b - a - 1);
+}
+
+inline bool areSectionFacesConnected(uint16_t connectivity, int a, int b) {
+    return a == b || (connectivity >> sectionFacePairBit(a, b)) & 1;
+}
+
+// Flood fills the open blocks of one section of the volume.
+uint16_t computeSectionConnectivity(const MeshVolume& volume, int sectionY);
+
+#endif // SECTION_CONNECTIVITY_H
@@ -0,0 +1,98 @@
+#include "paletted_container.h"
+#include <array>
+#include <algorithm>
+
+PalettedContainer::PalettedContainer(size_t size, VoxelType fill)
+    : size(size), bitsPerEntry(1), mask(1), palette{fill},
+      data((size * bitsPerEntry + 63) / 64, 0) {
+}
+
+PalettedContainer::PalettedContainer(const VoxelType* values, size_t size)
+    : size(size) {
+    // Build the palette in one pass so the bulk import picks its final width up front.
+    std::array<int, 256> paletteIndex;
+    paletteIndex.fill(-1);
+    for (size_t i = 0; i < size; ++i) {
+        if (paletteIndex[values[i]] < 0) {
+            paletteIndex[values[i]] = static_cast<int>(palette.size());
+            palette.push_back(values[i]);
+        }
+    }
+    if (palette.empty()) {
+        palette.push_back(AIR);
+    }
+
+    bitsPerEntry = bitsForPaletteSize(palette.size());
+    mask = (uint64_t(1) << bitsPerEntry) - 1;
+    data.assign((size * bitsPerEntry + 63) / 64, 0);
+
+    for (size_t i = 0; i < size; ++i) {
+        writeIndex(i, static_cast<uint64_t>(paletteIndex[values[i]]));
+    }
+}
+
+void PalettedContainer::set(size_t index, VoxelType type) {
+    if (index >= size) {
+        return;
+    }
+
+    auto it = std::find(palette.begin(), palette.end(), type);
+    size_t paletteIndex = it - palette.begin();
+    if (it == palette.end()) {
+        palette.push_back(type);
+        if (palette.size() > (size_t(1) << bitsPerEntry)) {
+            resize(bitsPerEntry * 2);
+        }
+    }
+
+    writeIndex(index, paletteIndex);
+}
+
+size_t PalettedContainer::getSize() const {
+    return size;
+}
+
+int PalettedContainer::getBitsPerEntry() const {
+    return bitsPerEntry;
+}
+
+size_t PalettedContainer::getPaletteSize() const {
+    return palette.size();
+}
+
+size_t PalettedContainer::getMemoryUsage() const {
+    return sizeof(PalettedContainer) +
+           palette.capacity() * sizeof(VoxelType) +
+           data.capacity() * sizeof(uint64_t);
+}
+
+int PalettedContainer::bitsForPaletteSize(size_t paletteSize) {
+    int bits = 1;
+    while ((size_t(1) << bits) < paletteSize) {
+        bits *= 2;
+    }
+    return bits;
+}
+
+void PalettedContainer::resize(int newBitsPerEntry) {
+    std::vector<uint64_t> oldData;
+    oldData.swap(data);
+    int oldBitsPerEntry = bitsPerEntry;
+    uint64_t oldMask = mask;
+
+    bitsPerEntry = newBitsPerEntry;
+    mask = (uint64_t(1) << bitsPerEntry) - 1;
+    data.assign((size * bitsPerEntry + 63) / 64, 0);
+
+    for (size_t i = 0; i < size; ++i) {
+        size_t bitIndex = i * oldBitsPerEntry;
+        writeIndex(i, (oldData[bitIndex >> 6] >> (bitIndex & 63)) & oldMask);
+    }
+}
+
+void PalettedContainer::writeIndex(size_t index, uint64_t paletteIndex) {
+    size_t bitIndex = index * bitsPerEntry;
+    uint64_t& word = data[bitIndex >> 6];
+    int shift = bitIndex & 63;
+    word = (word & ~(mask << shift)) | (paletteIndex << shift);
+}
@@ -0,0 +1,43 @@
+#ifndef PALETTED_CONTAINER_H
+#define PALETTED_CONTAINER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../voxel/types.h"
+
+// Block storage that keeps a small local palette of the VoxelTypes in use and
+// bit-packs palette indices at 1, 2, 4 or 8 bits per block. Widths are powers of
+// two so an entry never straddles two words and reads stay a shift and a mask.
+// The width doubles automatically when set() introduces a type that doesn't fit.
+class PalettedContainer {
+public:
+    explicit PalettedContainer(size_t size = 0, VoxelType fill = AIR);
+    PalettedContainer(const VoxelType* values, size_t size);
+
+    VoxelType get(size_t index) const {
+        size_t bitIndex = index * bitsPerEntry;
+        uint64_t word = data[bitIndex >> 6];
+        return palette[(word >> (bitIndex & 63)) & mask];
+    }
+
+    void set(size_t index, VoxelType type);
+
+    size_t getSize() const;
+    int getBitsPerEntry() const;
+    size_t getPaletteSize() const;
+    size_t getMemoryUsage() const;
+
+private:
+    static int bitsForPaletteSize(size_t paletteSize);
+    void resize(int newBitsPerEntry);
+    void writeIndex(size_t index, uint64_t paletteIndex);
+
+    size_t size;
+    int bitsPerEntry;
+    uint64_t mask;
+    std::vector<VoxelType> palette;
+    std::vector<uint64_t> data;
+};
+
+#endif // PALETTED_CONTAINER_H
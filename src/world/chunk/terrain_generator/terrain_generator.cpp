@@ -16,8 +16,8 @@ TerrainGenerator::TerrainGenerator(int width, int height, int depth, glm::vec2 i
     std::srand(seed);
 }
 
-void TerrainGenerator::generateTerrain(std::vector<Voxel*>& voxels, std::vector<Voxel*>& outsideChunkVoxels) {
-    voxels.resize(width * height * depth, nullptr);
+void TerrainGenerator::generateTerrain(std::vector<VoxelType>& voxels, std::vector<Voxel>& outsideChunkVoxels) {
+    voxels.assign(width * height * depth, AIR);
     // No need to resize the outside chunk voxels, as they won't be hashed.
 
     const int waterLevel = 62;
@@ -31,9 +31,10 @@ void TerrainGenerator::generateTerrain(std::vector<Voxel*>& voxels, std::vector<
             auto [primaryBiome, secondaryBiome, blendFactor] = determineBiome(temperature, humidity);
             int maxY = generateHeight(x, z, primaryBiome, secondaryBiome, blendFactor);
 
-            for (int y = 0; y < height; ++y) {
-                glm::vec3 voxelPosition(x, y, z);
-                unsigned int voxelIndex = coordsToIndex(voxelPosition);
+            // Everything above the surface and the water line stays air.
+            int columnTop = std::min(std::max(maxY, waterLevel), height);
+            for (int y = 0; y < columnTop; ++y) {
+                unsigned int voxelIndex = coordsToIndex(x, y, z);
 
                 if (y < maxY) {
                     VoxelType blockType = determineBlockType(y, maxY, primaryBiome, waterLevel);
@@ -42,17 +43,17 @@ void TerrainGenerator::generateTerrain(std::vector<Voxel*>& voxels, std::vector<
                     float caveDensity = generateCaveDensity(x, y, z);
                     if (caveDensity > 0.55f && y < maxY - 5) {
                         if (y < waterLevel) {
-                            voxels[voxelIndex] = new Voxel(voxelPosition, WATER);
+                            voxels[voxelIndex] = WATER;
                         }
                         continue;
                     }
 
-                    voxels[voxelIndex] = new Voxel(voxelPosition, blockType);
+                    voxels[voxelIndex] = blockType;
 
                     // Generate ores
                     generateOres(x, y, z, voxelIndex, blockType, voxels);
                 } else if (y < waterLevel) {
-                    voxels[voxelIndex] = new Voxel(voxelPosition, WATER);
+                    voxels[voxelIndex] = WATER;
                 }
             }
 
@@ -143,16 +144,16 @@ float TerrainGenerator::generateCaveDensity(int x, int y, int z) {
     return (caveNoise1 + 0.5f * caveNoise2) / 1.5f;
 }
 
-void TerrainGenerator::generateOres(int x, int y, int z, unsigned int voxelIndex, VoxelType blockType, std::vector<Voxel*>& voxels) {
+void TerrainGenerator::generateOres(int x, int y, int z, unsigned int voxelIndex, VoxelType blockType, std::vector<VoxelType>& voxels) {
     if (blockType == STONE) {
         float oreNoise = perlinNoise.noise((x + index_.x * width) * 0.2f, y * 0.2f, (z + index_.y * depth) * 0.2f);
         if (oreNoise > 0.8f) {
-            voxels[voxelIndex] = new Voxel({x, y, z}, IRONORE);
+            voxels[voxelIndex] = IRONORE;
         }
     }
 }
 
-void TerrainGenerator::addSurfaceFeatures(int x, int z, int maxY, BiomeType biome, int waterLevel, std::vector<Voxel*>& voxels, std::vector<Voxel*>& outsideChunkVoxels) {
+void TerrainGenerator::addSurfaceFeatures(int x, int z, int maxY, BiomeType biome, int waterLevel, std::vector<VoxelType>& voxels, std::vector<Voxel>& outsideChunkVoxels) {
     if (maxY < height - 1 && maxY > waterLevel) {
         // Use random number for feature generation
         float random = static_cast<float>(rand()) / RAND_MAX;
@@ -169,18 +170,18 @@ void TerrainGenerator::addSurfaceFeatures(int x, int z, int maxY, BiomeType biom
                 break;
             case PLAINS:
                 if (random < 0.01f) {
-                    voxels[coordsToIndex({x, maxY, z})] = new Voxel({x, maxY, z}, FLOWER, true);
+                    voxels[coordsToIndex(x, maxY, z)] = FLOWER;
                 } else if (random < 0.2f) {
-                    voxels[coordsToIndex({x, maxY, z})] = new Voxel({x, maxY, z}, TALLGRASS, true);
+                    voxels[coordsToIndex(x, maxY, z)] = TALLGRASS;
                 }
                 break;
             case FOREST:
                 if (random < 0.01f) {
                     generateTree(x, z, maxY, voxels, outsideChunkVoxels);
                 } else if (random < 0.05f) {
-                    voxels[coordsToIndex({x, maxY, z})] = new Voxel({x, maxY, z}, FLOWER, true);
+                    voxels[coordsToIndex(x, maxY, z)] = FLOWER;
                 } else if (random < 0.2f) {
-                    voxels[coordsToIndex({x, maxY, z})] = new Voxel({x, maxY, z}, TALLGRASS, true);
+                    voxels[coordsToIndex(x, maxY, z)] = TALLGRASS;
                 }
                 break;
             case DESERT:
@@ -193,11 +194,11 @@ void TerrainGenerator::addSurfaceFeatures(int x, int z, int maxY, BiomeType biom
 }
 
 
-void TerrainGenerator::generateTree(int x, int z, int y, std::vector<Voxel*>& voxels, std::vector<Voxel*>& outsideChunkVoxels) {
+void TerrainGenerator::generateTree(int x, int z, int y, std::vector<VoxelType>& voxels, std::vector<Voxel>& outsideChunkVoxels) {
     int treeHeight = 4 + rand() % 3;
     for (int i = 0; i < treeHeight; ++i) {
         if (y + i < height) {
-            voxels[coordsToIndex({x, y + i, z})] = new Voxel({x, y + i, z}, LOG);
+            voxels[coordsToIndex(x, y + i, z)] = LOG;
         }
     }
     for (int dx = -2; dx <= 2; ++dx) {
@@ -208,10 +209,10 @@ void TerrainGenerator::generateTree(int x, int z, int y, std::vector<Voxel*>& vo
                     int leafY = y + treeHeight + dy;
                     int leafZ = z + dz;
                     if (leafX >= 0 && leafX < width && leafZ >= 0 && leafZ < depth) {
-                        voxels[coordsToIndex({leafX, leafY, leafZ})] = new Voxel({leafX, leafY, leafZ}, LEAVES);
+                        voxels[coordsToIndex(leafX, leafY, leafZ)] = LEAVES;
                     } else {
                         // Voxels outside the chunk are not hashed.
-                        outsideChunkVoxels.push_back(new Voxel({leafX, leafY, leafZ}, LEAVES));
+                        outsideChunkVoxels.emplace_back(glm::vec3(leafX, leafY, leafZ), LEAVES);
                     }
 
                 }
@@ -220,28 +221,25 @@ void TerrainGenerator::generateTree(int x, int z, int y, std::vector<Voxel*>& vo
     }
 }
 
-void TerrainGenerator::generateCactus(int x, int z, int y, std::vector<Voxel*>& voxels) {
+void TerrainGenerator::generateCactus(int x, int z, int y, std::vector<VoxelType>& voxels) {
     int cactusHeight = 2 + rand() % 3;
     for (int i = 0; i < cactusHeight; ++i) {
         if (y + i < height) {
-            voxels[coordsToIndex({x, y + i, z})] = new Voxel({x, y + i, z}, CACTUS);
+            voxels[coordsToIndex(x, y + i, z)] = CACTUS;
         }
     }
 }
 
-void TerrainGenerator::generateIceSpike(int x, int z, int y, std::vector<Voxel*>& voxels) {
+void TerrainGenerator::generateIceSpike(int x, int z, int y, std::vector<VoxelType>& voxels) {
     int spikeHeight = 3 + rand() % 5;
     for (int i = 0; i < spikeHeight; ++i) {
         if (y + i < height) {
-            voxels[coordsToIndex({x, y + i, z})] = new Voxel({x, y + i, z}, ICE);
+            voxels[coordsToIndex(x, y + i, z)] = ICE;
         }
     }
 }
 
-unsigned int TerrainGenerator::coordsToIndex(glm::vec3 coords) const {
-    return static_cast<unsigned int>(
-        coords.x +
-        coords.y * width +
-        coords.z * width * height
-    );
+// Y-major column layout, matching ChunkSection, so columns copy straight into sections.
+unsigned int TerrainGenerator::coordsToIndex(int x, int y, int z) const {
+    return y + (z + x * depth) * height;
 }
@@ -28,19 +28,19 @@ struct BiomeParams {
 class TerrainGenerator {
 public:
     TerrainGenerator(int width, int height, int depth, glm::vec2 index, unsigned int seed);
-    void generateTerrain(std::vector<Voxel*>& voxels, std::vector<Voxel*>& outsideChunkVoxels);
+    void generateTerrain(std::vector<VoxelType>& voxels, std::vector<Voxel>& outsideChunkVoxels);
+    unsigned int coordsToIndex(int x, int y, int z) const;
 
 private:
     std::tuple<BiomeType, BiomeType, float> determineBiome(float temperature, float humidity);
     int generateHeight(int x, int z, BiomeType primaryBiome, BiomeType secondaryBiome, float blendFactor) const;
     VoxelType determineBlockType(int y, int maxY, BiomeType biome, int waterLevel);
     float generateCaveDensity(int x, int y, int z);
-    void generateOres(int x, int y, int z, unsigned int voxelIndex, VoxelType blockType, std::vector<Voxel*>& voxels);
-    void addSurfaceFeatures(int x, int z, int maxY, BiomeType biome, int waterLevel, std::vector<Voxel*>& voxels, std::vector<Voxel*>& outsideChunkVoxels);
-    void generateTree(int x, int z, int y, std::vector<Voxel*>& voxels, std::vector<Voxel*>& outsideChunkVoxels);
-    void generateCactus(int x, int z, int y, std::vector<Voxel*>& voxels);
-    void generateIceSpike(int x, int z, int y, std::vector<Voxel*>& voxels);
-    unsigned int coordsToIndex(glm::vec3 coords) const;
+    void generateOres(int x, int y, int z, unsigned int voxelIndex, VoxelType blockType, std::vector<VoxelType>& voxels);
+    void addSurfaceFeatures(int x, int z, int maxY, BiomeType biome, int waterLevel, std::vector<VoxelType>& voxels, std::vector<Voxel>& outsideChunkVoxels);
+    void generateTree(int x, int z, int y, std::vector<VoxelType>& voxels, std::vector<Voxel>& outsideChunkVoxels);
+    void generateCactus(int x, int z, int y, std::vector<VoxelType>& voxels);
+    void generateIceSpike(int x, int z, int y, std::vector<VoxelType>& voxels);
 
     int width, height, depth;
     glm::vec2 index_;
@@ -93,8 +93,8 @@ bool Player::checkCollision(const glm::vec3& position) {
 
                 std::shared_ptr<Chunk> chunk = chunkManager->getChunk(chunkPos);
                 if (chunk) {
-                    Voxel* voxel = chunk->getVoxel(localPos);
-                    if (voxel != nullptr && voxel->getStopsEntities() != true) { // Handle also tall grass
+                    VoxelType type = chunk->getVoxel(localPos);
+                    if (getBlockProperties(type).collides) { // Tall grass, flowers and water don't collide
                         return true;
                     }
                 }
@@ -0,0 +1,41 @@
+#ifndef BLOCK_PROPERTIES_H
+#define BLOCK_PROPERTIES_H
+
+#include <array>
+#include "types.h"
+
+struct BlockProperties {
+    bool isAir;
+    bool occludesFaces;  // Hides the faces of neighbouring blocks.
+    bool isTranslucent;  // Rendered in the water pass.
+    bool isXShaped;      // Rendered as two diagonal quads.
+    bool collides;       // Blocks player movement.
+};
+
+namespace detail {
+
+constexpr std::array<BlockProperties, 256> buildBlockPropertyTable() {
+    std::array<BlockProperties, 256> table{};
+    for (BlockProperties& properties : table) {
+        properties = {false, true, false, false, true};
+    }
+
+    table[AIR] = {true, false, false, false, false};
+    table[WATER] = {false, false, true, false, false};
+    table[TALLGRASS] = {false, false, false, true, false};
+    table[FLOWER] = {false, false, false, true, false};
+    // Leaves and cacti are cut out in the texture, so they don't hide their neighbours.
+    table[LEAVES] = {false, false, false, false, true};
+    table[CACTUS] = {false, false, false, false, true};
+    return table;
+}
+
+inline constexpr std::array<BlockProperties, 256> blockPropertyTable = buildBlockPropertyTable();
+
+} // namespace detail
+
+inline const BlockProperties& getBlockProperties(VoxelType type) {
+    return detail::blockPropertyTable[type];
+}
+
+#endif // BLOCK_PROPERTIES_H
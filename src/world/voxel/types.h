@@ -1,8 +1,10 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <cstdint>
 
-enum VoxelType{
+// Block IDs double as texture atlas indices, so they must stay below 256.
+enum VoxelType : uint8_t {
 
 
     GRASS = 0,
@@ -21,7 +23,8 @@ enum VoxelType{
     ICE = 67,
     CACTUS = 70,
     SANDSTONE = 176,
-    WATER = 223
+    WATER = 223,
+    AIR = 255
 
 };
 
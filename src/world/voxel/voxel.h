@@ -2,27 +2,25 @@
 #define VOXEL_H
 
 #include <glm/glm.hpp>
-#include <vector>
 #include "types.h"
+#include "block_properties.h"
 
+// Lightweight view of a single block. Chunks store plain VoxelType IDs and only
+// build a Voxel when a position is needed, e.g. for blocks placed outside the
+// chunk during generation.
 class Voxel {
 public:
 
-    Voxel(glm::vec3 position, VoxelType type, bool isXShaped = false);
+    Voxel(glm::vec3 position, VoxelType type);
     glm::vec3 getPosition() const;
     VoxelType getType() const;
     bool getIsXShaped() const;
     bool isTranslucent() const;
-    std::vector<float> getVertexData(const glm::vec3& offset, uint8_t faceFlags, float ao) const;
-    std::vector<unsigned int> getIndexData(unsigned int baseIndex, uint8_t faceFlags) const;
     bool getStopsEntities() const;
 
 private:
     glm::vec3 position;
     VoxelType type;
-    bool translucent;
-    bool isXShaped;
-    bool stopsEntities;
 };
 
 enum FaceFlags {
@@ -0,0 +1,360 @@
+// Frustum, section, occlusion and horizon culling without a GL context:
+// scripted camera poses over a flat grid of chunks, checked against a
+// brute-force reference, and occluders placed by hand.
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "engine/renderer/frustum.hpp"
+#include "engine/renderer/section_culling.h"
+#include "engine/renderer/occlusion_culler.h"
+#include "engine/renderer/horizon_culler.h"
+#include "world/chunk/chunk.h"
+
+namespace {
+
+constexpr int SECTION_COUNT = static_cast<int>(CHUNK_HEIGHT) / ChunkSection::SIZE;
+using SectionEnds = std::array<uint32_t, SECTION_COUNT>;
+
+int failures = 0;
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition);      \
+            failures++;                                                                    \
+        }                                                                                  \
+    } while (0)
+
+// Ten quads in each section listed, none in the others.
+SectionEnds makeSectionEnds(const std::vector<int>& sections) {
+    SectionEnds ends{};
+    uint32_t quads = 0;
+    for (int section = 0; section < SECTION_COUNT; ++section) {
+        for (int filled : sections) {
+            quads += filled == section ? 10 : 0;
+        }
+        ends[section] = quads;
+    }
+    return ends;
+}
+
+glm::mat4 viewProjection(const glm::vec3& position, float yawDegrees, float pitchDegrees) {
+    float yaw = glm::radians(yawDegrees);
+    float pitch = glm::radians(pitchDegrees);
+    glm::vec3 front(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), WINDOW_WIDTH / WINDOW_HEIGHT,
+                                            RENDERER_NEAR_PLANE_DISTANCE, RENDERER_FAR_PLANE_DISTANCE);
+    return projection * glm::lookAt(position, position + front, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+// True when any of a grid of points in the box projects inside the clip volume.
+bool isBoxOnScreen(const glm::mat4& matrix, const glm::vec3& min, const glm::vec3& max) {
+    const int steps = 4;
+    for (int i = 0; i <= steps; ++i) {
+        for (int j = 0; j <= steps; ++j) {
+            for (int k = 0; k <= steps; ++k) {
+                glm::vec3 point = min + (max - min) * glm::vec3(i, j, k) / static_cast<float>(steps);
+                glm::vec4 clip = matrix * glm::vec4(point, 1.0f);
+                if (clip.w > 0.0f && std::abs(clip.x) <= clip.w && std::abs(clip.y) <= clip.w &&
+                    std::abs(clip.z) <= clip.w) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void testRanges() {
+    std::vector<QuadRange> ranges;
+    auto everything = [](const glm::vec3&, const glm::vec3&) { return true; };
+    auto allSections = [](int) { return true; };
+
+    // Visible sections merge into one range; empty section 4 holds no quads,
+    // so it doesn't split them.
+    SectionEnds ends = makeSectionEnds({1, 2, 3, 5, 6});
+    SectionCullResult result = findVisibleSections(glm::ivec2(0), ends, allSections, everything, ranges);
+    CHECK(result.sections == 5);
+    CHECK(result.sectionsVisible == 5);
+    CHECK(result.chunkVisible);
+    CHECK(ranges.size() == 1 && ranges[0].first == 0 && ranges[0].count == 50);
+
+    // A hidden section splits its neighbours.
+    result = findVisibleSections(
+        glm::ivec2(0), ends, allSections, [](const glm::vec3& min, const glm::vec3&) { return min.y != 32.0f; },
+        ranges);
+    CHECK(result.sectionsVisible == 4);
+    CHECK(ranges.size() == 2 && ranges[0].first == 0 && ranges[0].count == 10);
+    CHECK(ranges.size() == 2 && ranges[1].first == 20 && ranges[1].count == 30);
+
+    // So does a section rejected by the section test.
+    result = findVisibleSections(glm::ivec2(0), ends, [](int section) { return section != 2; }, everything, ranges);
+    CHECK(result.sectionsVisible == 4);
+    CHECK(ranges.size() == 2 && ranges[0].first == 0 && ranges[0].count == 10);
+    CHECK(ranges.size() == 2 && ranges[1].first == 20 && ranges[1].count == 30);
+
+    // The chunk box spans only the non-empty sections, and a hidden chunk
+    // costs a single box test.
+    int boxTests = 0;
+    glm::vec3 chunkMin, chunkMax;
+    result = findVisibleSections(glm::ivec2(2, -3), ends, allSections,
+                                 [&](const glm::vec3& min, const glm::vec3& max) {
+                                     if (boxTests++ == 0) {
+                                         chunkMin = min;
+                                         chunkMax = max;
+                                     }
+                                     return false;
+                                 },
+                                 ranges);
+    CHECK(boxTests == 1);
+    CHECK(!result.chunkVisible && ranges.empty());
+    CHECK(chunkMin == glm::vec3(32.0f, 16.0f, -48.0f));
+    CHECK(chunkMax == glm::vec3(48.0f, 112.0f, -32.0f));
+
+    // Empty chunks are not counted at all.
+    result = findVisibleSections(glm::ivec2(0), SectionEnds{}, allSections, everything, ranges);
+    CHECK(result.sections == 0 && !result.chunkVisible && ranges.empty());
+}
+
+struct Pose {
+    const char* name;
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+void testPoses() {
+    // Terrain-like chunks: the bottom five sections hold quads.
+    SectionEnds ends = makeSectionEnds({0, 1, 2, 3, 4});
+    const Pose poses[] = {
+        {"ground, level", glm::vec3(8.0f, 70.0f, 8.0f), -90.0f, 0.0f},
+        {"ground, level 45", glm::vec3(8.0f, 70.0f, 8.0f), -45.0f, 0.0f},
+        {"ground, down 30", glm::vec3(8.0f, 70.0f, 8.0f), 0.0f, -30.0f},
+        {"ground, up 60", glm::vec3(8.0f, 70.0f, 8.0f), 90.0f, 60.0f},
+        {"100 up, down 89", glm::vec3(8.0f, 170.0f, 8.0f), -90.0f, -89.0f},
+        {"chunk corner, level", glm::vec3(0.0f, 40.0f, 0.0f), 180.0f, 0.0f},
+    };
+
+    std::vector<QuadRange> ranges;
+    for (const Pose& pose : poses) {
+        glm::mat4 matrix = viewProjection(pose.position, pose.yaw, pose.pitch);
+        Frustum frustum(matrix);
+        uint64_t sections = 0;
+        uint64_t visible = 0;
+        uint64_t missed = 0;
+        uint64_t visibleQuads = 0;
+        for (int x = -VIEW_DISTANCE; x <= VIEW_DISTANCE; ++x) {
+            for (int z = -VIEW_DISTANCE; z <= VIEW_DISTANCE; ++z) {
+                glm::ivec2 chunkPos(x, z);
+                SectionCullResult result = findVisibleSections(
+                    chunkPos, ends, [](int) { return true; },
+                    [&](const glm::vec3& min, const glm::vec3& max) { return frustum.isBoxVisible(min, max); },
+                    ranges);
+                sections += result.sections;
+                visible += result.sectionsVisible;
+                for (const QuadRange& range : ranges) {
+                    visibleQuads += range.count;
+                }
+
+                // Culling must be conservative: no section with a point on
+                // screen may be dropped.
+                for (int section = 0; section < 5; ++section) {
+                    glm::vec3 min(x * CHUNK_WIDTH, section * ChunkSection::SIZE, z * CHUNK_DEPTH);
+                    glm::vec3 max = min + glm::vec3(CHUNK_WIDTH, ChunkSection::SIZE, CHUNK_DEPTH);
+                    bool drawn = false;
+                    for (const QuadRange& range : ranges) {
+                        drawn = drawn || (range.first <= section * 10u && section * 10u < range.first + range.count);
+                    }
+                    if (!drawn && isBoxOnScreen(matrix, min, max)) {
+                        missed++;
+                    }
+                }
+            }
+        }
+        CHECK(missed == 0);
+        CHECK(visibleQuads == visible * 10);
+        double culled = 1.0 - static_cast<double>(visible) / static_cast<double>(sections);
+        std::printf("%-20s %5llu of %5llu sections visible, %5.1f%% culled\n", pose.name,
+                    static_cast<unsigned long long>(visible), static_cast<unsigned long long>(sections), 100.0 * culled);
+        CHECK(visible > 0);
+        CHECK(culled > 0.0);
+    }
+}
+
+void testOcclusionCuller() {
+    // Looking down -z at a wall 10 wide and 14 tall, 20 blocks away, whose
+    // top is 4 blocks above the eye.
+    glm::vec3 cameraPos(0.0f, 10.0f, 0.0f);
+    glm::mat4 matrix = viewProjection(cameraPos, -90.0f, 0.0f);
+    OcclusionCuller culler;
+    culler.beginFrame(matrix, cameraPos);
+    culler.addOccluder(glm::vec3(-5.0f, 0.0f, -21.0f), glm::vec3(5.0f, 14.0f, -20.0f));
+    CHECK(culler.getOccluderCount() == 1);
+
+    // Behind the wall.
+    CHECK(!culler.isBoxVisible(glm::vec3(-2.0f, 5.0f, -40.0f), glm::vec3(2.0f, 9.0f, -36.0f)));
+    CHECK(!culler.isBoxVisible(glm::vec3(-1.0f, 8.0f, -80.0f), glm::vec3(1.0f, 10.0f, -78.0f)));
+    // Beside, above, in front of and partly behind it.
+    CHECK(culler.isBoxVisible(glm::vec3(14.0f, 5.0f, -40.0f), glm::vec3(18.0f, 9.0f, -36.0f)));
+    CHECK(culler.isBoxVisible(glm::vec3(-14.0f, 5.0f, -40.0f), glm::vec3(-10.0f, 9.0f, -36.0f)));
+    CHECK(culler.isBoxVisible(glm::vec3(-2.0f, 25.0f, -40.0f), glm::vec3(2.0f, 29.0f, -36.0f)));
+    CHECK(culler.isBoxVisible(glm::vec3(-2.0f, 5.0f, -12.0f), glm::vec3(2.0f, 9.0f, -8.0f)));
+    CHECK(culler.isBoxVisible(glm::vec3(8.0f, 5.0f, -40.0f), glm::vec3(12.0f, 9.0f, -36.0f)));
+    // Boxes reaching behind the camera can't be projected and stay visible.
+    CHECK(culler.isBoxVisible(glm::vec3(-2.0f, 5.0f, -40.0f), glm::vec3(2.0f, 9.0f, 2.0f)));
+
+    // A new frame starts empty.
+    culler.beginFrame(matrix, cameraPos);
+    CHECK(culler.getOccluderCount() == 0);
+    CHECK(culler.isBoxVisible(glm::vec3(-2.0f, 5.0f, -40.0f), glm::vec3(2.0f, 9.0f, -36.0f)));
+}
+
+// Times a frame of terrain-like work: one 64-block-deep slab per chunk in
+// view distance as occluders, then every section above it tested.
+void benchmarkOcclusionCuller() {
+    glm::vec3 cameraPos(8.0f, 70.0f, 8.0f);
+    glm::mat4 matrix = viewProjection(cameraPos, -60.0f, -10.0f);
+    Frustum frustum(matrix);
+    OcclusionCuller culler;
+    const int frames = 50;
+    uint64_t tested = 0;
+    uint64_t hidden = 0;
+    double rasterMilliseconds = 0.0;
+    double testMilliseconds = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        culler.beginFrame(matrix, cameraPos);
+        for (int x = -VIEW_DISTANCE; x <= VIEW_DISTANCE; ++x) {
+            for (int z = -VIEW_DISTANCE; z <= VIEW_DISTANCE; ++z) {
+                glm::vec3 min(x * CHUNK_WIDTH, 0.0f, z * CHUNK_DEPTH);
+                glm::vec3 max = min + glm::vec3(CHUNK_WIDTH, 64.0f, CHUNK_DEPTH);
+                if (frustum.isBoxVisible(min, max)) {
+                    culler.addOccluder(min, max);
+                }
+            }
+        }
+        auto rastered = std::chrono::steady_clock::now();
+        for (int x = -VIEW_DISTANCE; x <= VIEW_DISTANCE; ++x) {
+            for (int z = -VIEW_DISTANCE; z <= VIEW_DISTANCE; ++z) {
+                for (int section = 0; section < SECTION_COUNT; ++section) {
+                    glm::vec3 min(x * CHUNK_WIDTH, section * ChunkSection::SIZE, z * CHUNK_DEPTH);
+                    glm::vec3 max = min + glm::vec3(CHUNK_WIDTH, ChunkSection::SIZE, CHUNK_DEPTH);
+                    if (frustum.isBoxVisible(min, max)) {
+                        tested++;
+                        hidden += !culler.isBoxVisible(min, max);
+                    }
+                }
+            }
+        }
+        auto done = std::chrono::steady_clock::now();
+        rasterMilliseconds += std::chrono::duration<double, std::milli>(rastered - start).count();
+        testMilliseconds += std::chrono::duration<double, std::milli>(done - rastered).count();
+    }
+    std::printf("occlusion culler: %zu occluders in %.3f ms, %llu tests in %.3f ms per frame, %.1f%% hidden\n",
+                culler.getOccluderCount(), rasterMilliseconds / frames,
+                static_cast<unsigned long long>(tested / frames), testMilliseconds / frames,
+                100.0 * static_cast<double>(hidden) / static_cast<double>(tested));
+    // Sections inside the slab are behind its top face.
+    CHECK(hidden > 0);
+}
+
+// A chunk of stone from y = 0 up to height and air above, built through
+// Chunk so the mesher sees it as it would see generated terrain.
+std::unique_ptr<Chunk> makeStoneChunk(int height) {
+    auto chunk = std::make_unique<Chunk>(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, glm::vec2(0.0f), nullptr, 1u);
+    for (int x = 0; x < static_cast<int>(CHUNK_WIDTH); ++x) {
+        for (int z = 0; z < static_cast<int>(CHUNK_DEPTH); ++z) {
+            for (int y = 0; y < static_cast<int>(CHUNK_HEIGHT); ++y) {
+                chunk->setVoxel(glm::ivec3(x, y, z), y < height ? STONE : AIR);
+            }
+        }
+    }
+    return chunk;
+}
+
+void fillColumn(Chunk& chunk, int x, int z, int minY, int maxY, VoxelType type) {
+    for (int y = minY; y < maxY; ++y) {
+        chunk.setVoxel(glm::ivec3(x, y, z), type);
+    }
+}
+
+// The occluder height the renderer gives a chunk: mesh it, then count its
+// solid layers.
+int findMeshedSolidHeight(const Chunk& chunk) {
+    MeshVolume volume(CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH);
+    volume.fill(chunk, {});
+    MeshData mesh;
+    ChunkMesher(MeshingMode::BINARY_GREEDY).buildMesh(volume, glm::vec3(0.0f), mesh);
+    return findSolidHeight(mesh.solidLayers);
+}
+
+void testHorizonCuller() {
+    // The camera is at y = 40 in chunk (0, 0). A wall chunk, stone up to
+    // y = 60, stands in (0, -1); behind it, in (0, -2), a lower chunk is
+    // stone up to y = 20.
+    glm::vec3 cameraPos(8.0f, 40.0f, 8.0f);
+    std::unique_ptr<Chunk> wall = makeStoneChunk(60);
+    std::unique_ptr<Chunk> lower = makeStoneChunk(20);
+    CHECK(findMeshedSolidHeight(*wall) == 60);
+    CHECK(findMeshedSolidHeight(*lower) == 20);
+
+    auto buildHorizon = [&](const Chunk& wallChunk) {
+        HorizonCuller culler;
+        culler.beginFrame(glm::ivec2(0), VIEW_DISTANCE + 1);
+        culler.setChunk(glm::ivec2(0, -1), findMeshedSolidHeight(wallChunk));
+        culler.setChunk(glm::ivec2(0, -2), findMeshedSolidHeight(*lower));
+        culler.buildHorizon(cameraPos);
+        return culler;
+    };
+    // The lower chunk's surface section, a section high above it, and the
+    // same surface section off to the side of the wall.
+    const glm::vec3 surfaceMin(0.0f, 16.0f, -32.0f);
+    const glm::vec3 surfaceMax(16.0f, 32.0f, -16.0f);
+    const glm::vec3 skyMin(0.0f, 96.0f, -32.0f);
+    const glm::vec3 skyMax(16.0f, 112.0f, -16.0f);
+    const glm::vec3 besideMin(32.0f, 16.0f, -32.0f);
+    const glm::vec3 besideMax(48.0f, 32.0f, -16.0f);
+
+    HorizonCuller culler = buildHorizon(*wall);
+    CHECK(culler.getOccluderCount() == 2);
+    CHECK(!culler.isBoxVisible(surfaceMin, surfaceMax));
+    CHECK(culler.isBoxVisible(skyMin, skyMax));
+    CHECK(culler.isBoxVisible(besideMin, besideMax));
+    // The camera's own chunk is never culled.
+    CHECK(culler.isBoxVisible(glm::vec3(0.0f), glm::vec3(16.0f)));
+
+    // One column of water in the wall lets rays through under its surface,
+    // and so does one column with a cave under an overhang. Either way the
+    // wall is only solid below the gap and must not hide the lower chunk.
+    std::unique_ptr<Chunk> flooded = makeStoneChunk(60);
+    fillColumn(*flooded, 7, 9, 30, 60, WATER);
+    CHECK(findMeshedSolidHeight(*flooded) == 30);
+    CHECK(buildHorizon(*flooded).isBoxVisible(surfaceMin, surfaceMax));
+
+    std::unique_ptr<Chunk> overhang = makeStoneChunk(60);
+    fillColumn(*overhang, 3, 12, 10, 30, AIR);
+    CHECK(findMeshedSolidHeight(*overhang) == 10);
+    CHECK(buildHorizon(*overhang).isBoxVisible(surfaceMin, surfaceMax));
+}
+
+} // namespace
+
+int main() {
+    testRanges();
+    testPoses();
+    testOcclusionCuller();
+    benchmarkOcclusionCuller();
+    testHorizonCuller();
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}